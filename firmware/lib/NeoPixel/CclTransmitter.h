@@ -0,0 +1,88 @@
+//
+// Hardware transmitter for NeoPixel<..., NEO_TX_CCL>: the 800 kHz-class
+// waveform is built by the peripherals and the CPU only keeps the SPI
+// buffer fed, with interrupts enabled.
+//
+//   SPI0 (master, mode 0)  shifts the frame out MSB first; SCK is the bit
+//                          clock and MOSI the bit value
+//   TCB0 (single shot)     started by every rising SCK edge (through LUT1
+//                          and the event system), its output is high for
+//                          SHORT_PULSE_CYCLES: the high time of a 0 bit
+//   CCL LUT0               DOUT = SCK & (MOSI | TCB0): a 1 bit is high for
+//                          all of SCK high, a 0 bit for the TCB0 pulse
+//
+// Only LUT0 drives a pin, so the strip must be wired to PA4 (or PB4, the
+// LUT0 alternate output). The SPI and TCB0 pins are not used.
+//
+
+#ifndef NEOPIXEL_CCL_TRANSMITTER_H
+#define NEOPIXEL_CCL_TRANSMITTER_H
+
+#include <Arduino.h>
+
+namespace ccl {
+    // Timing, shared with the host waveform model (NeoSim/Waveform.h)
+    static constexpr uint8_t SPI_CLOCK_DIVIDER = 8;   ///< Bit period in CPU cycles: 1 MHz at 8 MHz
+    static constexpr uint8_t SHORT_PULSE_CYCLES = 2;  ///< TCB0 pulse, T0H
+
+    /// true if the CCL can drive the pin
+    static constexpr bool canDrive(int8_t pin) { return pin == PIN_PA4 || pin == PIN_PB4; }
+
+#ifdef __AVR__
+    template<int8_t Pin>
+    struct Transmitter {
+        static void begin() {
+            // SPI0: master, SCK = F_CPU / 8, buffered, SS pin not used
+            SPI0.CTRLA = 0;
+            SPI0.CTRLB = SPI_BUFEN_bm | SPI_SSD_bm | SPI_MODE_0_gc;
+            SPI0.CTRLA = SPI_MASTER_bm | SPI_CLK2X_bm | SPI_PRESC_DIV16_gc | SPI_ENABLE_bm;
+
+            // TCB0: single shot of SHORT_PULSE_CYCLES on every event
+            TCB0.CTRLA = 0;
+            TCB0.CTRLB = TCB_ASYNC_bm | TCB_CNTMODE_SINGLE_gc;
+            TCB0.EVCTRL = TCB_CAPTEI_bm;
+            TCB0.CCMP = SHORT_PULSE_CYCLES;
+            TCB0.CNT = SHORT_PULSE_CYCLES;  // idle with the output low
+            TCB0.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;
+
+            // LUT1 passes SCK on to the event system, which starts TCB0
+            CCL.CTRLA = 0;
+            CCL.LUT1CTRLA = 0;
+            CCL.LUT1CTRLB = CCL_INSEL0_SPI0_gc | CCL_INSEL1_MASK_gc;
+            CCL.LUT1CTRLC = CCL_INSEL2_MASK_gc;
+            CCL.TRUTH1 = 0b10101010;  // IN0
+            CCL.LUT1CTRLA = CCL_ENABLE_bm;
+            EVSYS.ASYNCCH0 = EVSYS_ASYNCCH0_CCL_LUT1_gc;
+            EVSYS.ASYNCUSER0 = EVSYS_ASYNCUSER0_ASYNCCH0_gc;  // TCB0
+
+            // LUT0 makes the waveform: IN0 = SCK, IN1 = MOSI, IN2 = TCB0
+            if (Pin == PIN_PB4)
+                PORTMUX.CTRLA |= PORTMUX_LUT0_bm;
+            CCL.LUT0CTRLA = 0;
+            CCL.LUT0CTRLB = CCL_INSEL0_SPI0_gc | CCL_INSEL1_SPI0_gc;
+            CCL.LUT0CTRLC = CCL_INSEL2_TCB0_gc;
+            CCL.TRUTH0 = 0b10101000;  // IN0 & (IN1 | IN2)
+            CCL.LUT0CTRLA = CCL_OUTEN_bm | CCL_ENABLE_bm;
+            CCL.CTRLA = CCL_ENABLE_bm;
+        }
+
+        /*!
+          @brief   Send a frame. Interrupts stay enabled: the SPI buffer holds
+                   two bytes (16 us), and an interrupt that outlasts it only
+                   stretches the low time of the current bit, which the
+                   strip takes for a pause well under its 80 us reset.
+        */
+        static void send(const uint8_t *data, uint16_t numBytes) {
+            SPI0.INTFLAGS = SPI_TXCIF_bm;
+            for (uint16_t i = 0; i < numBytes; i++) {
+                while (!(SPI0.INTFLAGS & SPI_DREIF_bm));
+                SPI0.DATA = data[i];
+            }
+            // wait for the last byte to leave the shift register
+            while (!(SPI0.INTFLAGS & SPI_TXCIF_bm));
+        }
+    };
+#endif
+}
+
+#endif // NEOPIXEL_CCL_TRANSMITTER_H
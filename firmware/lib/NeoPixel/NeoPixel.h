@@ -38,11 +38,14 @@
 
 #include <Arduino.h>
 
-#ifndef __AVR__
-#error "This library only supports AVR processors."
-#endif
+#include "CclTransmitter.h"
 
+#ifdef __AVR__
 #include "AttinyPins.h"
+#else
+// Host build: frames are handed to the NeoSim recorder instead of a pin
+#include <NeoSim.h>
+#endif
 
 
 // The order of primary colors in the NeoPixel data stream can vary among
@@ -110,6 +113,13 @@ static constexpr uint8_t NEO_BRGW = ((3 << 6) | (1 << 4) | (2 << 2) | (0)); ///<
 static constexpr uint8_t NEO_BGWR = ((2 << 6) | (3 << 4) | (1 << 2) | (0)); ///< Transmit as B,G,W,R
 static constexpr uint8_t NEO_BGRW = ((3 << 6) | (2 << 4) | (1 << 2) | (0)); ///< Transmit as B,G,R,W
 
+// Options, the last template parameter of NeoPixel. One transmitter:
+static constexpr uint8_t NEO_TX_BITBANG = 0x00; ///< Timed asm loop, interrupts off while sending
+static constexpr uint8_t NEO_TX_CCL = 0x01;     ///< CCL + SPI + TCB0 (CclTransmitter.h), PA4/PB4 only
+static constexpr uint8_t NEO_TX_MASK = 0x01;
+// and flags:
+static constexpr uint8_t NEO_UNSCALED = 0x04;      ///< Brightness applied by show(), the framebuffer keeps colors as set
+
 
 // These two tables are declared outside the NeoPixel class
 // because some boards may require oldschool compilers that don't
@@ -150,7 +160,7 @@ for x in range(256):
     print("{:3},".format(int(math.pow((x)/255.0,gamma)*255.0+0.5))),
     if x&15 == 15: print
 */
-static const uint8_t PROGMEM _NeoPixelGammaTable[256] = {
+static constexpr uint8_t PROGMEM _NeoPixelGammaTable[256] = {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1,
         1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 3,
@@ -170,16 +180,66 @@ static const uint8_t PROGMEM _NeoPixelGammaTable[256] = {
         218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252,
         255};
 
+/* The fast hue path, ColorHueGamma() and rainbow(), runs on two tables that
+   the compiler works out from the gamma table and the strip length.
+   _NeoPixelHueTable is the red channel of the color wheel at hue x/256 of a
+   turn, gamma included: full within 1/6 turn of red, off past 1/3, a
+   linear ramp in between. Green and blue are the same curve a third and
+   two thirds of a turn on. */
+struct _NeoPixelHueTable {
+  uint8_t values[256];
+};
+
+constexpr _NeoPixelHueTable _neoPixelHueTable() {
+  _NeoPixelHueTable table{};
+  for (uint16_t x = 0; x < 256; x++) {
+    uint16_t distance = 3 * (x < 128 ? x : 256 - x); // From red, 1/768 turns
+    uint8_t level = distance <= 128 ? 255 : distance >= 256 ? 0 : (255 * (256 - distance) + 64) / 128;
+    table.values[x] = _NeoPixelGammaTable[level];
+  }
+  return table;
+}
+
+static constexpr _NeoPixelHueTable PROGMEM _NeoPixelHueGammaTable = _neoPixelHueTable();
+
+/* Hue offset of every pixel when one color wheel is spread over Count
+   pixels: the 32-bit division of rainbow() done once. */
+template<uint16_t Count>
+struct _NeoPixelHueSpread {
+  uint16_t values[Count];
+};
+
+template<uint16_t Count>
+constexpr _NeoPixelHueSpread<Count> _neoPixelHueSpread() {
+  _NeoPixelHueSpread<Count> spread{};
+  for (uint32_t i = 0; i < Count; i++)
+    spread.values[i] = i * 65536 / Count;
+  return spread;
+}
+
 /*!
     @brief  Class that stores state and functions for interacting with
             Adafruit NeoPixels and compatible devices.
+    @tparam CurrentBudget  Optional peak current limit, expressed as the
+            largest sum of all channel values (0-255 each) a frame may
+            have. show() scales heavier frames down to it; 0 disables
+            the limiter.
+    @tparam Options  NEO_TX_xxx transmitter, NEO_TX_BITBANG by default,
+            or'ed with NEO_UNSCALED for a brightness that does not touch
+            the framebuffer.
 */
 
-template<uint16_t NumPins, int8_t Pin, uint8_t NeoPixelType = NEO_GRB>
+template<uint16_t NumPins, int8_t Pin, uint8_t NeoPixelType = NEO_GRB, uint16_t CurrentBudget = 0,
+         uint8_t Options = NEO_TX_BITBANG>
 class NeoPixel {
 private:
     static_assert(Pin >= 0, "Invalid pin number");
+    static constexpr bool cclTx = (Options & NEO_TX_MASK) == NEO_TX_CCL;
+    static_assert(!cclTx || ccl::canDrive(Pin), "NEO_TX_CCL needs the strip on PA4 or PB4 (CCL LUT0 output)");
+    static constexpr bool unscaled = Options & NEO_UNSCALED;
+#ifdef __AVR__
     using PIN = PinInfo<Pin>;
+#endif
 
     static constexpr int8_t pin = Pin;                                ///< Output pin number (-1 if not yet set)
     static constexpr uint16_t numLEDs = NumPins;                      ///< Number of RGB LEDs in strip
@@ -188,14 +248,126 @@ private:
     static constexpr uint8_t bOffset = NeoPixelType & 0b11;           ///< Index of blue byte
     static constexpr uint8_t wOffset = (NeoPixelType >> 6) & 0b11;    ///< Index of white (==rOffset if no white)
     static constexpr uint16_t numBytes = NumPins * ((wOffset == rOffset) ? 3 : 4);  ///< Size of 'pixels' buffer below
+    static constexpr uint16_t txBytes = (CurrentBudget || unscaled) ? numBytes : 1;  ///< Size of 'txBuffer' below
+    static_assert(!CurrentBudget || numBytes <= 65535 / 255, "Channel sum must fit 16 bits");
 
     bool begun = false;                                               ///< true if begin() previously called
+    bool dirty = true;                                                ///< 'pixels' changed since the last show()
+    uint16_t skipped = 0;                                             ///< show() calls with nothing new to send
     uint8_t brightness = 0;                                           ///< Strip brightness 0-255 (stored as +1)
     uint8_t pixels[numBytes]{};                                       ///< Holds LED color values (3 or 4 bytes each)
+    uint8_t txBuffer[txBytes]{};                                      ///< Scaled copy of 'pixels' for show()
 
     uint32_t endTime = 0;                                             ///< Latch timing reference
 
+    static constexpr _NeoPixelHueSpread<NumPins> PROGMEM hueSpread = _neoPixelHueSpread<NumPins>();  ///< rainbow() hue offsets
+
+    /*!
+      @brief   Frame to transmit, at the NEO_UNSCALED brightness and under
+               CurrentBudget. The channel sum is a plain 16-bit add per
+               byte; the two scales are fused into one, so a frame pays
+               for at most one 8x8-bit multiply per byte, into txBuffer:
+               the framebuffer keeps its values.
+      @return  'pixels' if the frame goes out as it is, else 'txBuffer'.
+    */
+    uint8_t *scaleFrame(void) {
+      uint8_t scale = unscaled ? brightness : 0; // Q8, 0 for none
+      if (CurrentBudget) {
+        uint16_t sum = 0;
+        for (uint16_t i = 0; i < numBytes; i++)
+          sum += pixels[i];
+        uint16_t sent = scale ? ((uint32_t) sum * scale) >> 8 : sum;
+        // sum >= sent > CurrentBudget, so the Q8 scale always fits in a
+        // byte, and it is below the brightness. A frame over 256 times the
+        // limit scales to 0, which would read as no scale: 1/256 sends
+        // every byte as 0, still within the limit
+        if (sent > CurrentBudget) {
+          scale = ((uint32_t) CurrentBudget << 8) / sum;
+          if (!scale)
+            scale = 1;
+        }
+      }
+      if (!scale)
+        return pixels;
+
+      for (uint16_t i = 0; i < numBytes; i++)
+        txBuffer[i] = (pixels[i] * (uint16_t) scale) >> 8;
+      return txBuffer;
+    }
+
+    /*!
+      @brief   Brightness applied to colors as they are stored, 0 for
+               none: with NEO_UNSCALED, show() applies it instead.
+    */
+    uint8_t storeScale(void) const { return unscaled ? 0 : brightness; }
+
+    /*!
+      @brief   Store one byte of the framebuffer, noting whether the frame
+               changed. Rewriting a pixel with its current color (as the
+               rainbow effects do for most of the strip) leaves it clean.
+    */
+    void store(uint8_t *p, uint8_t value) {
+      if (*p != value) {
+        *p = value;
+        dirty = true;
+      }
+    }
+
+    /*!
+      @brief   Store the three wire-order bytes of an RGB pixel, scaled
+               by 'scale' unless 0.
+    */
+    void storePixel(uint8_t *p, const uint8_t *wire, uint8_t scale) {
+      if (scale) {
+        store(&p[0], (wire[0] * scale) >> 8);
+        store(&p[1], (wire[1] * scale) >> 8);
+        store(&p[2], (wire[2] * scale) >> 8);
+      } else {
+        store(&p[0], wire[0]);
+        store(&p[1], wire[1]);
+        store(&p[2], wire[2]);
+      }
+    }
+
+    /*!
+      @brief   Index one past the last pixel of a range, clipped to the
+               strip; 'count' 0 for the rest of the strip, as in fill().
+    */
+    static uint16_t clipEnd(uint16_t first, uint16_t count) {
+      if (first >= numLEDs)
+        return first;
+      if (count == 0 || count > numLEDs - first)
+        return numLEDs;
+      return first + count;
+    }
+
 public:
+    /*!
+      @brief   One pixel of an RGB strip as its three bytes go out on the
+               wire, e.g. G,R,B for NEO_GRB. The order is resolved at
+               compile time, so setPixel() and friends store bytes as they
+               are, where setPixelColor() unpacks a 32-bit color with
+               shifts (a few instructions each on AVR).
+    */
+    struct Pixel {
+      uint8_t wire[3]; ///< Bytes in data-stream order
+
+      constexpr Pixel() : wire{0, 0, 0} {}
+
+      /*!
+        @param   r  Red brightness, 0 to 255.
+        @param   g  Green brightness, 0 to 255.
+        @param   b  Blue brightness, 0 to 255.
+      */
+      constexpr Pixel(uint8_t r, uint8_t g, uint8_t b)
+          : wire{rOffset == 0 ? r : gOffset == 0 ? g : b, rOffset == 1 ? r : gOffset == 1 ? g : b,
+                 rOffset == 2 ? r : gOffset == 2 ? g : b} {}
+
+      constexpr uint8_t red(void) const { return wire[rOffset]; }
+      constexpr uint8_t green(void) const { return wire[gOffset]; }
+      constexpr uint8_t blue(void) const { return wire[bOffset]; }
+    };
+
     NeoPixel() {
       clear();
     }
@@ -209,17 +381,38 @@ public:
     void begin() {
       pinMode(pin, OUTPUT);
       digitalWrite(pin, LOW);
+#ifdef __AVR__
+      if constexpr (cclTx)
+        ccl::Transmitter<Pin>::begin();
+#endif
       begun = true;
+      dirty = true; // Whatever the strip shows now, the first frame goes out
     }
 
     void show(void) {
+      // The strip keeps showing the last frame it latched, so an unchanged
+      // framebuffer is not sent again: no latch wait, no interrupts held off.
+      if (!dirty) {
+        skipped++;
+        return;
+      }
+      dirty = false;
+
+      // Brightness and the current limiter run before waiting for the latch,
+      // so their cost is hidden in the 300 us the strip needs anyway.
+      uint8_t *data = (CurrentBudget || unscaled) ? scaleFrame() : pixels;
+
       // Data latch = 300+ microsecond pause in the output stream. Rather than
       // put a delay at the end of the function, the ending time is noted and
       // the function will simply hold off (if needed) on issuing the
       // subsequent round of data until the latch time has elapsed. This
       // allows the mainline code to start generating the next frame of data
       // rather than stalling for the latch.
-      while (!canShow());
+      while (!canShow()) {
+#ifndef __AVR__
+        neosim::advance(1); // Virtual time only moves when told to
+#endif
+      }
       // endTime is a private member (rather than global var) so that multiple
       // instances on different pins can be quickly issued in succession (each
       // instance doesn't delay the next).
@@ -234,10 +427,18 @@ public:
       // state, computes 'pin high' and 'pin low' values, and writes these back
       // to the PORT register as needed.
 
+#ifdef __AVR__
+      if constexpr (cclTx) {
+        // The peripherals shape the bits, interrupts can stay on
+        ccl::Transmitter<Pin>::send(data, numBytes);
+        endTime = micros();
+        return;
+      }
+
       // AVR MCUs -- ATmega & ATtiny (no XMEGA) ---------------------------------
 
       volatile uint16_t i = numBytes; // Loop counter
-      volatile uint8_t *ptr = pixels; // Pointer to next byte
+      volatile uint8_t *ptr = data;   // Pointer to next byte
       volatile uint8_t b = *ptr++;    // Current byte value
       volatile uint8_t hi;            // PORT w/output bit set high
       volatile uint8_t lo;            // PORT w/output bit set low
@@ -502,69 +703,77 @@ public:
 #endif // end F_CPU ifdefs on __AVR__
 
       // END AVR ----------------------------------------------------------------
+#else
+      // Host build: record the frame, the simulated clock covers the
+      // transmission time
+      neosim::show(data, numBytes);
+#endif
 
       endTime = micros(); // Save EOD time for latch on next call
     }
 
     void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
       if (n < numLEDs) {
-        if (brightness) { // See notes in setBrightness()
-          r = (r * brightness) >> 8;
-          g = (g * brightness) >> 8;
-          b = (b * brightness) >> 8;
+        uint8_t scale = storeScale();
+        if (scale) { // See notes in setBrightness()
+          r = (r * scale) >> 8;
+          g = (g * scale) >> 8;
+          b = (b * scale) >> 8;
         }
         uint8_t *p;
         if (wOffset == rOffset) { // Is an RGB-type strip
           p = &pixels[n * 3];     // 3 bytes per pixel
         } else {                  // Is a WRGB-type strip
           p = &pixels[n * 4];     // 4 bytes per pixel
-          p[wOffset] = 0;         // But only R,G,B passed -- set W to 0
+          store(&p[wOffset], 0);  // But only R,G,B passed -- set W to 0
         }
-        p[rOffset] = r; // R,G,B always stored
-        p[gOffset] = g;
-        p[bOffset] = b;
+        store(&p[rOffset], r); // R,G,B always stored
+        store(&p[gOffset], g);
+        store(&p[bOffset], b);
       }
     }
 
     void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
       if (n < numLEDs) {
-        if (brightness) { // See notes in setBrightness()
-          r = (r * brightness) >> 8;
-          g = (g * brightness) >> 8;
-          b = (b * brightness) >> 8;
-          w = (w * brightness) >> 8;
+        uint8_t scale = storeScale();
+        if (scale) { // See notes in setBrightness()
+          r = (r * scale) >> 8;
+          g = (g * scale) >> 8;
+          b = (b * scale) >> 8;
+          w = (w * scale) >> 8;
         }
         uint8_t *p;
         if (wOffset == rOffset) { // Is an RGB-type strip
           p = &pixels[n * 3];     // 3 bytes per pixel (ignore W)
         } else {                  // Is a WRGB-type strip
           p = &pixels[n * 4];     // 4 bytes per pixel
-          p[wOffset] = w;         // Store W
+          store(&p[wOffset], w);  // Store W
         }
-        p[rOffset] = r; // Store R,G,B
-        p[gOffset] = g;
-        p[bOffset] = b;
+        store(&p[rOffset], r); // Store R,G,B
+        store(&p[gOffset], g);
+        store(&p[bOffset], b);
       }
     }
 
     void setPixelColor(uint16_t n, uint32_t c) {
       if (n < numLEDs) {
         uint8_t *p, r = (uint8_t) (c >> 16), g = (uint8_t) (c >> 8), b = (uint8_t) c;
-        if (brightness) { // See notes in setBrightness()
-          r = (r * brightness) >> 8;
-          g = (g * brightness) >> 8;
-          b = (b * brightness) >> 8;
+        uint8_t scale = storeScale();
+        if (scale) { // See notes in setBrightness()
+          r = (r * scale) >> 8;
+          g = (g * scale) >> 8;
+          b = (b * scale) >> 8;
         }
         if (wOffset == rOffset) {
           p = &pixels[n * 3];
         } else {
           p = &pixels[n * 4];
           uint8_t w = (uint8_t) (c >> 24);
-          p[wOffset] = brightness ? ((w * brightness) >> 8) : w;
+          store(&p[wOffset], scale ? ((w * scale) >> 8) : w);
         }
-        p[rOffset] = r;
-        p[gOffset] = g;
-        p[bOffset] = b;
+        store(&p[rOffset], r);
+        store(&p[gOffset], g);
+        store(&p[bOffset], b);
       }
     }
 
@@ -586,11 +795,211 @@ public:
           end = numLEDs;
       }
 
+      if constexpr (wOffset == rOffset) {
+        // RGB strip: unpack and scale the color once, not once per pixel
+        fillPixels(Pixel((uint8_t) (c >> 16), (uint8_t) (c >> 8), (uint8_t) c), first, end - first);
+        return;
+      }
       for (i = first; i < end; i++) {
         this->setPixelColor(i, c);
       }
     }
 
+    /*!
+      @brief   Set a pixel of an RGB strip from its wire-order bytes,
+               scaled by the brightness unless NEO_UNSCALED is set.
+      @param   n  Pixel index, starting from 0; out of range does nothing.
+      @param   c  Color, see Pixel.
+    */
+    void setPixel(uint16_t n, Pixel c) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      if (n < numLEDs)
+        storePixel(&pixels[n * 3], c.wire, storeScale());
+    }
+
+    /*!
+      @brief   A pixel of an RGB strip as stored, without the rounding
+               back of getPixelColor(): with brightness applied to stored
+               colors (no NEO_UNSCALED), that is the scaled color.
+      @param   n  Pixel index, starting from 0.
+      @return  The pixel, black if out of range.
+    */
+    Pixel getPixel(uint16_t n) const {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      Pixel c;
+      if (n < numLEDs)
+        memcpy(c.wire, &pixels[n * 3], 3);
+      return c;
+    }
+
+    /*!
+      @brief   Add a color to a pixel of an RGB strip, each channel
+               saturating at 255 instead of wrapping around: light that
+               overlaps adds up until it clips, as it would on the strip.
+               Scaled by the brightness unless NEO_UNSCALED is set.
+      @param   n      Pixel index, starting from 0; out of range does
+                      nothing.
+      @param   c      Color, see Pixel.
+      @param   level  Share of the color added, 255 for all of it, as
+                      with scalePixels().
+    */
+    void addPixel(uint16_t n, Pixel c, uint8_t level = 255) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      if (n >= numLEDs)
+        return;
+      uint16_t factor = (uint16_t) level + 1;
+      uint8_t scale = storeScale();
+      uint8_t *p = &pixels[n * 3];
+      for (uint8_t i = 0; i < 3; i++) {
+        uint8_t add = (c.wire[i] * factor) >> 8;
+        if (scale)
+          add = (add * scale) >> 8;
+        uint16_t sum = p[i] + add;
+        store(&p[i], sum > 255 ? 255 : sum);
+      }
+    }
+
+    /*!
+      @brief   fill() for RGB strips: one color into a range of pixels,
+               scaled once rather than once per pixel.
+      @param   c      Color, see Pixel.
+      @param   first  Index of the first pixel to fill, starting from 0.
+      @param   count  Number of pixels to fill, 0 (the default) to the end
+                      of the strip. The range is clipped to the strip.
+    */
+    void fillPixels(Pixel c, uint16_t first = 0, uint16_t count = 0) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      uint16_t end = clipEnd(first, count);
+      if (first >= end)
+        return;
+      uint8_t scale = storeScale();
+      if (scale) {
+        for (uint8_t i = 0; i < 3; i++)
+          c.wire[i] = (c.wire[i] * scale) >> 8;
+      }
+      for (uint8_t *p = &pixels[first * 3], *stop = &pixels[end * 3]; p < stop; p += 3)
+        storePixel(p, c.wire, 0);
+    }
+
+    /*!
+      @brief   Copy a range of pixels within the strip as stored, with no
+               brightness applied again. The ranges may overlap.
+      @param   to     Index of the first destination pixel.
+      @param   from   Index of the first source pixel.
+      @param   count  Number of pixels, clipped to whichever range ends
+                      first.
+    */
+    void copyPixels(uint16_t to, uint16_t from, uint16_t count) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      if (to >= numLEDs || from >= numLEDs || to == from)
+        return;
+      uint16_t room = numLEDs - (to > from ? to : from);
+      uint16_t bytes = (count < room ? count : room) * 3;
+      uint8_t *dst = &pixels[to * 3];
+      const uint8_t *src = &pixels[from * 3];
+      if (to < from) {
+        for (uint16_t i = 0; i < bytes; i++)
+          store(&dst[i], src[i]);
+      } else {
+        for (uint16_t i = bytes; i-- > 0;)
+          store(&dst[i], src[i]);
+      }
+    }
+
+    /*!
+      @brief   Shift a range of pixels by some places, as stored, blanking
+               the places left behind. Pixels shifted out of the range are
+               lost.
+      @param   by     Places towards the end of the strip, or towards
+                      pixel 0 if negative.
+      @param   first  Index of the first pixel of the range.
+      @param   count  Number of pixels in the range, 0 (the default) to
+                      the end of the strip.
+    */
+    void shiftPixels(int16_t by, uint16_t first = 0, uint16_t count = 0) {
+      uint16_t end = clipEnd(first, count);
+      if (first >= end)
+        return;
+      uint16_t span = end - first;
+      uint16_t places = by < 0 ? -by : by;
+      if (places >= span) {
+        fillPixels(Pixel(), first, span);
+      } else if (by > 0) {
+        copyPixels(first + places, first, span - places);
+        fillPixels(Pixel(), first, places);
+      } else if (by < 0) {
+        copyPixels(first, first + places, span - places);
+        fillPixels(Pixel(), end - places, places);
+      }
+    }
+
+    /*!
+      @brief   Rotate a range of pixels by some places, as stored: pixels
+               pushed off one end of the range come back in at the other.
+               Each pixel is moved once, through a single 3-byte
+               temporary (cycle leader rotation), with no bounds checks
+               past the range.
+      @param   by     Places towards the end of the strip, or towards
+                      pixel 0 if negative; taken modulo the range.
+      @param   first  Index of the first pixel of the range.
+      @param   count  Number of pixels in the range, 0 (the default) to
+                      the end of the strip.
+    */
+    void rotatePixels(int16_t by, uint16_t first = 0, uint16_t count = 0) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      uint16_t end = clipEnd(first, count);
+      if (first >= end)
+        return;
+      uint16_t span = end - first;
+      // places towards the end, 0 to span - 1
+      int16_t places = by % (int16_t) span;
+      uint16_t k = places < 0 ? span + places : places;
+      if (k == 0)
+        return;
+      // the rotation splits into gcd(span, k) cycles of span / gcd pixels
+      uint16_t cycles = span, step = k;
+      while (step) {
+        uint16_t rest = cycles % step;
+        cycles = step;
+        step = rest;
+      }
+      uint8_t *base = &pixels[first * 3];
+      for (uint16_t start = 0; start < cycles; start++) {
+        uint8_t held[3];
+        memcpy(held, &base[start * 3], 3);
+        uint16_t to = start;
+        for (;;) {
+          uint16_t from = to >= k ? to - k : to + span - k;
+          if (from == start)
+            break;
+          storePixel(&base[to * 3], &base[from * 3], 0);
+          to = from;
+        }
+        storePixel(&base[to * 3], held, 0);
+      }
+    }
+
+    /*!
+      @brief   Scale a range of pixels by a level, as stored: each byte is
+               multiplied by level + 1 and divided by 256, so 255 leaves
+               the range as it is and 0 turns it off. One 8x8-bit multiply
+               per byte, for fades and trails that dim what is on the
+               strip rather than repaint it.
+      @param   level  Scale, 0 to 255.
+      @param   first  Index of the first pixel of the range.
+      @param   count  Number of pixels in the range, 0 (the default) to
+                      the end of the strip.
+    */
+    void scalePixels(uint8_t level, uint16_t first = 0, uint16_t count = 0) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      uint16_t end = clipEnd(first, count);
+      if (level == 255 || first >= end)
+        return;
+      uint16_t factor = level + 1;
+      for (uint8_t *p = &pixels[first * 3], *stop = &pixels[end * 3]; p < stop; p++)
+        store(p, (*p * factor) >> 8);
+    }
+
     void setBrightness(uint8_t b) {
       // Stored brightness value is different than what's passed.
       // This simplifies the actual scaling math later, allowing a fast
@@ -599,6 +1008,15 @@ public:
       // (color values are interpreted literally; no scaling), 1 = min
       // brightness (off), 255 = just below max brightness.
       uint8_t newBrightness = b + 1;
+      if (unscaled) {
+        // The framebuffer holds the colors as set, show() scales each
+        // frame on its way out: nothing to redo, and nothing lost
+        if (newBrightness != brightness) {
+          brightness = newBrightness;
+          dirty = true;
+        }
+        return;
+      }
       if (newBrightness != brightness) { // Compare against prior value
         // Brightness has changed -- re-scale existing data in RAM,
         // This process is potentially "lossy," especially when increasing
@@ -621,13 +1039,23 @@ public:
           scale = (((uint16_t) newBrightness << 8) - 1) / oldBrightness;
         for (uint16_t i = 0; i < numBytes; i++) {
           c = *ptr;
-          *ptr++ = (c * scale) >> 8;
+          store(ptr++, (c * scale) >> 8);
         }
         brightness = newBrightness;
       }
     }
 
-    void clear(void) { memset(pixels, 0, numBytes); }
+    void clear(void) {
+      for (uint16_t i = 0; i < numBytes; i++)
+        store(&pixels[i], 0);
+    }
+
+    /*!
+      @brief   Number of show() calls that returned at once because the
+               framebuffer had not changed since the previous frame was
+               sent. Wraps around at 65535.
+    */
+    uint16_t skippedShows(void) const { return skipped; }
 
 
     /*!
@@ -685,11 +1113,11 @@ public:
       if (n >= numLEDs)
         return 0; // Out of bounds, return no color.
 
-      uint8_t *p;
+      const uint8_t *p;
 
       if (wOffset == rOffset) { // Is RGB-type device
         p = &pixels[n * 3];
-        if (brightness) {
+        if (storeScale()) {
           // Stored color was decimated by setBrightness(). Returned value
           // attempts to scale back to an approximation of the original 24-bit
           // value used when setting the pixel color, but there will always be
@@ -705,7 +1133,7 @@ public:
         }
       } else { // Is RGBW-type device
         p = &pixels[n * 4];
-        if (brightness) { // Return scaled color
+        if (storeScale()) { // Return scaled color
           return (static_cast<uint32_t>((p[wOffset] << 8) / brightness) << 24) |
                  (static_cast<uint32_t>((p[rOffset] << 8) / brightness) << 16) |
                  (static_cast<uint32_t>((p[gOffset] << 8) / brightness) << 8) |
@@ -748,6 +1176,32 @@ public:
       return pgm_read_byte(&_NeoPixelGammaTable[x]); // 0-255 in, 0-255 out
     }
 
+    /*!
+      @brief   gamma32(ColorHSV(hue << 8)) for a fully saturated, full
+               value color, from three table reads and no multiply: the
+               hue is 8-bit, 1/256 of a turn, with 0 red as in ColorHSV().
+      @param   hue  Hue, 0 to 255; wraps around like the 16-bit hue.
+      @return  Gamma-adjusted packed RGB color.
+    */
+    static uint32_t ColorHueGamma(uint8_t hue) {
+      // Green peaks 85.3 steps after red and blue 170.7: rounded to whole steps
+      uint8_t r = pgm_read_byte(&_NeoPixelHueGammaTable.values[hue]);
+      uint8_t g = pgm_read_byte(&_NeoPixelHueGammaTable.values[(uint8_t) (hue - 85)]);
+      uint8_t b = pgm_read_byte(&_NeoPixelHueGammaTable.values[(uint8_t) (hue - 171)]);
+      return Color(r, g, b);
+    }
+
+    /*!
+      @brief   ColorHueGamma() as a Pixel, for setPixel().
+      @param   hue  Hue, 0 to 255.
+      @return  Gamma-adjusted color in wire order.
+    */
+    static Pixel PixelHueGamma(uint8_t hue) {
+      static_assert(wOffset == rOffset, "Pixel is for 3-byte (RGB) strips");
+      uint32_t c = ColorHueGamma(hue);
+      return Pixel((uint8_t) (c >> 16), (uint8_t) (c >> 8), (uint8_t) c);
+    }
+
     /*!
       @brief   Convert separate red, green and blue values into a single
                "packed" 32-bit RGB color.
@@ -882,9 +1336,30 @@ public:
       return x; // Packed 32-bit return
     }
 
+    /*!
+      @brief   Hue of a pixel when one color wheel is spread over the
+               strip, as rainbow() lays it out: n * 65536 / numPixels(),
+               read from a table built at compile time.
+      @param   n  Pixel index, starting from 0; must be in range.
+      @return  16-bit hue offset, for ColorHSV() or, rounded to 8 bits,
+               ColorHueGamma().
+    */
+    static uint16_t pixelHue(uint16_t n) {
+      return pgm_read_word(&hueSpread.values[n]);
+    }
+
     void rainbow(uint16_t first_hue = 0, int8_t reps = 1,
                  uint8_t saturation = 255, uint8_t brightness = 255,
                  bool gammify = true) {
+      if (reps == 1 && saturation == 255 && brightness == 255 && gammify) {
+        // One wheel at full color: the table path, rounding each pixel's
+        // hue to 8 bits once
+        for (uint16_t i = 0; i < numLEDs; i++) {
+          uint16_t hue = first_hue + pixelHue(i) + 128;
+          setPixelColor(i, ColorHueGamma(hue >> 8));
+        }
+        return;
+      }
       for (uint16_t i = 0; i < numLEDs; i++) {
         uint16_t hue = first_hue + (i * reps * 65536) / numLEDs;
         uint32_t color = ColorHSV(hue, saturation, brightness);
@@ -0,0 +1,78 @@
+//
+// Host stand-in for the parts of the Arduino core used by the firmware.
+// Time is virtual: delay() only moves the NeoSim clock, so animations run
+// as fast as the host can compute them.
+//
+
+#ifndef NEOSIM_ARDUINO_H
+#define NEOSIM_ARDUINO_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *) (addr))
+#define pgm_read_word(addr) (*(const uint16_t *) (addr))
+#define pgm_read_ptr(addr) (*(void *const *) (addr))
+
+#define cli()
+#define sei()
+
+static constexpr uint8_t LOW = 0;
+static constexpr uint8_t HIGH = 1;
+
+static constexpr uint8_t INPUT = 0;
+static constexpr uint8_t OUTPUT = 1;
+static constexpr uint8_t INPUT_PULLUP = 2;
+
+static constexpr uint8_t CHANGE = 4;
+static constexpr uint8_t FALLING = 2;
+static constexpr uint8_t RISING = 3;
+
+// ATtiny816 (20 pin) numbering, as in megaTinyCore
+static constexpr uint8_t PIN_PA4 = 0;
+static constexpr uint8_t PIN_PA5 = 1;
+static constexpr uint8_t PIN_PA6 = 2;
+static constexpr uint8_t PIN_PA7 = 3;
+static constexpr uint8_t PIN_PB5 = 4;
+static constexpr uint8_t PIN_PB4 = 5;
+static constexpr uint8_t PIN_PB3 = 6;
+static constexpr uint8_t PIN_PB2 = 7;
+static constexpr uint8_t PIN_PB1 = 8;
+static constexpr uint8_t PIN_PB0 = 9;
+static constexpr uint8_t PIN_PC0 = 10;
+static constexpr uint8_t PIN_PC1 = 11;
+static constexpr uint8_t PIN_PC2 = 12;
+static constexpr uint8_t PIN_PC3 = 13;
+static constexpr uint8_t PIN_PA1 = 14;
+static constexpr uint8_t PIN_PA2 = 15;
+static constexpr uint8_t PIN_PA3 = 16;
+static constexpr uint8_t PIN_PA0 = 17;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(unsigned int us);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+// avr/eeprom.h, over the EEPROM of NeoSim.h
+uint8_t eeprom_read_byte(const uint8_t *address);
+uint16_t eeprom_read_word(const uint16_t *address);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+void eeprom_update_word(uint16_t *address, uint16_t value);
+
+// interrupts run when a scheduled input change is applied (NeoSim.h)
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(uint8_t interrupt, void (*isr)(), uint8_t mode);
+void detachInterrupt(uint8_t interrupt);
+
+#endif // NEOSIM_ARDUINO_H
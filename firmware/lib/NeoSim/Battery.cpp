@@ -0,0 +1,31 @@
+#include "Battery.h"
+
+#include <stdint.h>
+
+namespace {
+    // Typical CR2032 figures against the depth of discharge, interpolated
+    // linearly: a lithium coin cell holds about 2.9 V for most of its
+    // capacity, its resistance goes up several times near the end
+    constexpr uint8_t POINTS = 7;
+    constexpr float DEPTH[POINTS] = {0.0f, 0.05f, 0.5f, 0.8f, 0.9f, 0.95f, 1.0f};
+    constexpr float OPEN_CIRCUIT_V[POINTS] = {3.2f, 3.0f, 2.95f, 2.85f, 2.7f, 2.5f, 2.0f};
+    constexpr float RESISTANCE_OHM[POINTS] = {12.0f, 12.0f, 15.0f, 20.0f, 30.0f, 45.0f, 80.0f};
+
+    float interpolate(const float *values, float depth) {
+        if (depth <= DEPTH[0])
+            return values[0];
+        for (uint8_t i = 1; i < POINTS; i++) {
+            if (depth < DEPTH[i]) {
+                float t = (depth - DEPTH[i - 1]) / (DEPTH[i] - DEPTH[i - 1]);
+                return values[i - 1] + t * (values[i] - values[i - 1]);
+            }
+        }
+        return values[POINTS - 1];
+    }
+}
+
+namespace neosim {
+    float Battery::openCircuitV() const { return interpolate(OPEN_CIRCUIT_V, usedMah / capacityMah); }
+
+    float Battery::resistanceOhm() const { return interpolate(RESISTANCE_OHM, usedMah / capacityMah); }
+}
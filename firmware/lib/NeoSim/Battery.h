@@ -0,0 +1,31 @@
+//
+// CR2032 discharge model for the supply monitor: the voltage the core reads
+// depends on how much charge has been drawn and on the current drawn at the
+// time, through the internal resistance of the cell.
+//
+
+#ifndef NEOSIM_BATTERY_H
+#define NEOSIM_BATTERY_H
+
+namespace neosim {
+    struct Battery {
+        float capacityMah = 225.0f;     ///< CR2032 nominal, to 2.0 V at light load
+        float usedMah = 0;
+
+        /// Voltage with no load, falling with the depth of discharge: flat
+        /// for most of the capacity, then down to 2.0 V
+        float openCircuitV() const;
+
+        /// Internal resistance, rising steeply towards the end
+        float resistanceOhm() const;
+
+        /// Voltage at the terminals while batteryMa is drawn
+        float loadedV(float batteryMa) const { return openCircuitV() - batteryMa * resistanceOhm() / 1000.0f; }
+
+        void draw(float mAh) { usedMah += mAh; }
+
+        bool empty() const { return usedMah >= capacityMah; }
+    };
+}
+
+#endif // NEOSIM_BATTERY_H
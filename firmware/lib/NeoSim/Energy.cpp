@@ -0,0 +1,68 @@
+#include "Energy.h"
+
+namespace {
+    // mA * us -> mAh
+    constexpr float MA_US_PER_MAH = 3.6e9f;
+
+    // 4 bytes per pixel when the white offset differs from the red one
+    uint8_t pixelStride(uint8_t neoPixelType) {
+        return ((neoPixelType >> 6) & 3) == ((neoPixelType >> 4) & 3) ? 3 : 4;
+    }
+}
+
+namespace neosim {
+    float PowerModel::batteryMa(float ledMa) const {
+        float efficiency = boostEfficiency[0];
+        if (ledMa >= boostLoadMa[2]) {
+            efficiency = boostEfficiency[2];
+        } else {
+            for (uint8_t i = 0; i < 2; i++) {
+                if (ledMa >= boostLoadMa[i] && ledMa < boostLoadMa[i + 1]) {
+                    float t = (ledMa - boostLoadMa[i]) / (boostLoadMa[i + 1] - boostLoadMa[i]);
+                    efficiency = boostEfficiency[i] + t * (boostEfficiency[i + 1] - boostEfficiency[i]);
+                }
+            }
+        }
+        return ledMa * ledSupplyV / (efficiency * batteryV) + boostQuiescentMa;
+    }
+
+    float frameLedMa(const Frame &frame, uint8_t neoPixelType, const PowerModel &model) {
+        // same encoding as the NEO_xxx constants: 0bWWRRGGBB byte offsets
+        uint8_t offsets[3] = {(uint8_t) ((neoPixelType >> 4) & 3), (uint8_t) ((neoPixelType >> 2) & 3),
+                              (uint8_t) (neoPixelType & 3)};
+        uint8_t stride = pixelStride(neoPixelType);
+
+        float ma = 0;
+        for (size_t p = 0; p + stride <= frame.bytes.size(); p += stride) {
+            ma += model.ledIdleMa;
+            for (uint8_t c = 0; c < 3; c++)
+                ma += frame.bytes[p + offsets[c]] * model.channelMa[c] / 255.0f;
+        }
+        return ma;
+    }
+
+    EnergyReport estimateEnergy(const std::vector<Frame> &frames, uint32_t endUs, uint8_t neoPixelType,
+                                uint32_t asleepUs, const PowerModel &model) {
+        EnergyReport report{0, 0, 0, endUs};
+        float chargeMaUs = 0;
+
+        // before the first frame the strip is powered but dark
+        size_t leds = frames.empty() ? 0 : frames.front().bytes.size() / pixelStride(neoPixelType);
+        float darkMa = model.batteryMa(leds * model.ledIdleMa) + model.mcuActiveMa;
+        chargeMaUs += darkMa * (frames.empty() ? endUs : frames.front().time);
+
+        for (size_t f = 0; f < frames.size(); f++) {
+            uint32_t until = f + 1 < frames.size() ? frames[f + 1].time : endUs;
+            float ma = model.batteryMa(frameLedMa(frames[f], neoPixelType, model)) + model.mcuActiveMa;
+            chargeMaUs += ma * (until - frames[f].time);
+            if (ma > report.peakMa) {
+                report.peakMa = ma;
+                report.worstFrame = f;
+            }
+        }
+        // the frames are held on the strip whether the core is awake or not
+        chargeMaUs -= (model.mcuActiveMa - model.mcuStandbyMa) * asleepUs;
+        report.mAh = chargeMaUs / MA_US_PER_MAH;
+        return report;
+    }
+}
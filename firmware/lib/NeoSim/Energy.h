@@ -0,0 +1,50 @@
+//
+// Battery energy estimate for a recorded run: every frame is held on the
+// strip until the next one starts, and the LED current it draws is brought
+// back to the CR2032 through the TPS61240 boost converter.
+//
+
+#ifndef NEOSIM_ENERGY_H
+#define NEOSIM_ENERGY_H
+
+#include "NeoSim.h"
+
+namespace neosim {
+    struct PowerModel {
+        // SK6805-2427 (MINI-J), typical datasheet figures
+        float channelMa[3] = {5.0f, 5.0f, 5.0f};   ///< R, G, B current at 255
+        float ledIdleMa = 0.3f;                     ///< Per LED, all channels off
+        float ledSupplyV = 5.0f;                    ///< TPS61240 fixed output
+
+        // TPS61240: efficiency rises from power-save mode at light load to
+        // PWM operation; interpolated linearly between these points
+        float boostLoadMa[3] = {1.0f, 10.0f, 50.0f};
+        float boostEfficiency[3] = {0.75f, 0.85f, 0.90f};
+        float boostQuiescentMa = 0.03f;
+
+        float batteryV = 3.0f;                      ///< CR2032 under load
+        float mcuActiveMa = 2.1f;                   ///< ATtiny816, 8 MHz at 3 V
+        float mcuStandbyMa = 0.001f;                ///< Standby, RTC on the 32 kHz ULP
+
+        /// Battery current for a given current drawn on the 5 V rail
+        float batteryMa(float ledMa) const;
+    };
+
+    struct EnergyReport {
+        float mAh;                  ///< Charge drawn from the battery for the run
+        float peakMa;               ///< Highest battery current of any frame
+        size_t worstFrame;          ///< Frame drawing peakMa
+        uint32_t durationUs;
+    };
+
+    /// Current on the 5 V rail while a frame is displayed
+    float frameLedMa(const Frame &frame, uint8_t neoPixelType, const PowerModel &model);
+
+    /// Replay frames recorded between time 0 and endUs, with the boost
+    /// converter on for the whole run and the MCU in standby for asleepUs
+    /// of it (neosim::sleptUs())
+    EnergyReport estimateEnergy(const std::vector<Frame> &frames, uint32_t endUs, uint8_t neoPixelType,
+                                uint32_t asleepUs = 0, const PowerModel &model = PowerModel());
+}
+
+#endif // NEOSIM_ENERGY_H
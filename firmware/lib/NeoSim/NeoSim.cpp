@@ -0,0 +1,228 @@
+#include "NeoSim.h"
+#include "Arduino.h"
+
+namespace {
+    uint32_t clockUs = 0;
+    uint32_t asleepUs = 0;
+    std::vector<neosim::Frame> recorded;
+    uint8_t pins[32] = {};
+    uint32_t wakes = 0;
+
+    struct Interrupt {
+        void (*isr)();
+        uint8_t mode;
+    };
+    Interrupt interrupts[sizeof(pins)] = {};
+
+    struct PinChange {
+        uint32_t time;
+        uint8_t pin;
+        uint8_t level;
+    };
+    std::vector<PinChange> scheduled;   // by time
+
+    uint16_t supplyMv = 3000;
+    uint16_t (*supplySource)() = nullptr;
+
+    uint8_t eeprom[neosim::EEPROM_SIZE];
+    uint32_t eepromWriteCounts[neosim::EEPROM_SIZE];
+    bool eepromErased = false;
+
+    // the EEPROM of a fresh chip, until the first eraseEeprom()
+    void eraseOnce() {
+        if (!eepromErased)
+            neosim::eraseEeprom();
+    }
+
+    void applyChanges() {
+        while (!scheduled.empty() && (int32_t) (scheduled.front().time - clockUs) <= 0) {
+            PinChange change = scheduled.front();
+            scheduled.erase(scheduled.begin());
+            uint8_t was = pins[change.pin];
+            pins[change.pin] = change.level;
+            const Interrupt &interrupt = interrupts[change.pin];
+            if (!interrupt.isr || was == change.level)
+                continue;
+            if (interrupt.mode == CHANGE || (interrupt.mode == FALLING && change.level == LOW) ||
+                (interrupt.mode == RISING && change.level == HIGH))
+                interrupt.isr();
+        }
+    }
+
+    // avr-libc random(): Park-Miller minimal standard generator, reproduced
+    // so the host picks the same colors and animations as the board
+    unsigned long randomNext = 1;
+
+    long doRandom() {
+        long x = (long) randomNext;
+        if (x == 0)
+            x = 123459876L;
+        long hi = x / 127773L;
+        long lo = x % 127773L;
+        x = 16807L * lo - 2836L * hi;
+        if (x < 0)
+            x += 0x7fffffffL;
+        randomNext = (unsigned long) x;
+        return x % (0x7fffffffL + 1UL);
+    }
+}
+
+namespace neosim {
+    void reset() {
+        clockUs = 0;
+        asleepUs = 0;
+        recorded.clear();
+        randomNext = 1;
+        memset(pins, 0, sizeof(pins));
+        wakes = 0;
+        memset(interrupts, 0, sizeof(interrupts));
+        scheduled.clear();
+        supplyMv = 3000;
+        supplySource = nullptr;
+    }
+
+    uint32_t now() { return clockUs; }
+
+    void advance(uint32_t us) { clockUs += us; }
+
+    void sleep(uint32_t us) {
+        if (!scheduled.empty() && (int32_t) (scheduled.front().time - (clockUs + us)) < 0) {
+            int32_t early = scheduled.front().time - clockUs;
+            us = early > 0 ? early : 0;
+        }
+        clockUs += us;
+        asleepUs += us;
+        applyChanges();
+    }
+
+    bool powerDown() {
+        if (scheduled.empty())
+            return false;
+        int32_t wait = scheduled.front().time - clockUs;
+        if (wait > 0) {
+            clockUs += wait;
+            asleepUs += wait;
+        }
+        wakes++;
+        applyChanges();
+        return true;
+    }
+
+    uint32_t sleptUs() { return asleepUs; }
+
+    uint32_t wakeUps() { return wakes; }
+
+    void schedulePin(uint8_t pin, uint8_t level, uint32_t atUs) {
+        if (pin >= sizeof(pins))
+            return;
+        auto at = scheduled.begin();
+        while (at != scheduled.end() && (int32_t) (at->time - atUs) <= 0)
+            at++;
+        scheduled.insert(at, PinChange{atUs, pin, level});
+    }
+
+    void show(const uint8_t *bytes, uint16_t numBytes) {
+        recorded.push_back(Frame{clockUs, std::vector<uint8_t>(bytes, bytes + numBytes)});
+        clockUs += numBytes * BYTE_TIME_US;
+    }
+
+    const std::vector<Frame> &frames() { return recorded; }
+
+    void eraseEeprom() {
+        memset(eeprom, 0xff, sizeof(eeprom));
+        memset(eepromWriteCounts, 0, sizeof(eepromWriteCounts));
+        eepromErased = true;
+    }
+
+    uint32_t eepromWrites(uint16_t address) {
+        eraseOnce();
+        return address < EEPROM_SIZE ? eepromWriteCounts[address] : 0;
+    }
+
+    uint8_t pinState(uint8_t pin) { return pin < sizeof(pins) ? pins[pin] : LOW; }
+
+    void setSupplyMillivolts(uint16_t millivolts) {
+        supplyMv = millivolts;
+        supplySource = nullptr;
+    }
+
+    void setSupplySource(uint16_t (*source)()) { supplySource = source; }
+
+    uint16_t supplyMillivolts() { return supplySource ? supplySource() : supplyMv; }
+}
+
+uint32_t millis() { return clockUs / 1000; }
+
+uint32_t micros() { return clockUs; }
+
+void delay(uint32_t ms) { clockUs += ms * 1000; }
+
+void delayMicroseconds(unsigned int us) { clockUs += us; }
+
+long random(long howbig) {
+    if (howbig == 0)
+        return 0;
+    return doRandom() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig)
+        return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0)
+        randomNext = seed;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (mode == INPUT_PULLUP && pin < sizeof(pins))
+        pins[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < sizeof(pins))
+        pins[pin] = val;
+}
+
+int digitalRead(uint8_t pin) { return neosim::pinState(pin); }
+
+// a floating pin: the seed taken from it in setup() is arbitrary but fixed
+int analogRead(uint8_t) { return 0; }
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), uint8_t mode) {
+    if (interrupt < sizeof(pins))
+        interrupts[interrupt] = Interrupt{isr, mode};
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if (interrupt < sizeof(pins))
+        interrupts[interrupt] = Interrupt{};
+}
+
+uint8_t eeprom_read_byte(const uint8_t *address) {
+    eraseOnce();
+    uintptr_t at = (uintptr_t) address;
+    return at < neosim::EEPROM_SIZE ? eeprom[at] : 0xff;
+}
+
+uint16_t eeprom_read_word(const uint16_t *address) {
+    const uint8_t *at = (const uint8_t *) address;
+    return eeprom_read_byte(at) | (uint16_t) eeprom_read_byte(at + 1) << 8;
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value) {
+    eraseOnce();
+    uintptr_t at = (uintptr_t) address;
+    if (at < neosim::EEPROM_SIZE && eeprom[at] != value) {
+        eeprom[at] = value;
+        eepromWriteCounts[at]++;
+    }
+}
+
+void eeprom_update_word(uint16_t *address, uint16_t value) {
+    uint8_t *at = (uint8_t *) address;
+    eeprom_update_byte(at, value & 0xff);
+    eeprom_update_byte(at + 1, value >> 8);
+}
@@ -0,0 +1,116 @@
+//
+// NeoSim: host-side simulation backend for the NeoHeart firmware.
+//
+// Provides the virtual clock behind the Arduino.h stand-in and records
+// every frame NeoPixel::show() would have sent to the strip, so the
+// animations in firmware.h can be run and inspected on a Linux box.
+//
+
+#ifndef NEOSIM_H
+#define NEOSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace neosim {
+    // time needed to clock out one byte at 800 kHz (8 bits * 1.25 us)
+    static constexpr uint32_t BYTE_TIME_US = 10;
+
+    // ATtiny816 data EEPROM
+    static constexpr uint16_t EEPROM_SIZE = 128;
+
+    struct Frame {
+        uint32_t time;                  ///< Virtual time when the frame started, us
+        std::vector<uint8_t> bytes;     ///< Buffer as sent, in wire order
+    };
+
+    /// Rewind the clock, drop recorded frames and reset the PRNG, pins,
+    /// interrupts, scheduled inputs, sleep counts and the supply. The EEPROM
+    /// is kept, as on the board
+    void reset();
+
+    /// Erase the EEPROM to 0xff and clear its write counts
+    void eraseEeprom();
+
+    /// Times an EEPROM byte has been written since eraseEeprom(); rewriting
+    /// the value a byte already holds does not count
+    uint32_t eepromWrites(uint16_t address);
+
+    /// Virtual time since reset() in microseconds
+    uint32_t now();
+
+    /// Move the virtual clock forward
+    void advance(uint32_t us);
+
+    /// Move the virtual clock forward with the core asleep. A scheduled
+    /// input change wakes the core up early, as its interrupt would
+    void sleep(uint32_t us);
+
+    /// Sleep in power-down until the next scheduled input change. Returns
+    /// false at once if there is none: nothing could wake the core up
+    bool powerDown();
+
+    /// Virtual time spent in sleep() and powerDown() since reset(), us
+    uint32_t sleptUs();
+
+    /// powerDown() calls that woke up since reset()
+    uint32_t wakeUps();
+
+    /// Drive an input pin to level at virtual time atUs: digitalRead()
+    /// returns it from then on, and the interrupt attached to the pin runs.
+    /// Changes are applied while the core sleeps, or when the clock has
+    /// passed them at the next sleep.
+    void schedulePin(uint8_t pin, uint8_t level, uint32_t atUs);
+
+    /// Record a frame and account for its transmission time
+    void show(const uint8_t *bytes, uint16_t numBytes);
+
+    const std::vector<Frame> &frames();
+
+    /// Last value written with digitalWrite() or scheduled, HIGH for
+    /// INPUT_PULLUP and LOW for untouched pins
+    uint8_t pinState(uint8_t pin);
+
+    /// Supply voltage of the core as the firmware's supply monitor reads it:
+    /// a fixed value, 3000 mV after reset(), or a source called on every
+    /// reading, e.g. a battery model (Battery.h) that knows the load
+    void setSupplyMillivolts(uint16_t millivolts);
+    void setSupplySource(uint16_t (*source)());
+    uint16_t supplyMillivolts();
+
+    // Frame traces -----------------------------------------------------------
+    //
+    // Binary layout, little endian:
+    //   "NHT1"                          magic
+    //   uint16  bytes per frame
+    //   uint32  frame count
+    //   per frame:
+    //     varint  start time minus the previous frame's start time, us
+    //     mask    (bytes per frame + 7) / 8 bytes, bit i set when byte i
+    //             differs from the previous frame (the first frame is
+    //             compared against an all-dark strip)
+    //     bytes   the changed bytes, in order
+    //
+    // Unchanged frames cost a few bytes, so whole animations stay small
+    // enough to be kept as golden files next to the tests.
+
+    std::vector<uint8_t> encodeTrace(const std::vector<Frame> &frames);
+
+    /// Returns false on a malformed trace
+    bool decodeTrace(const std::vector<uint8_t> &trace, std::vector<Frame> &frames);
+
+    bool writeTrace(const char *path, const std::vector<Frame> &frames);
+    bool readTrace(const char *path, std::vector<Frame> &frames);
+
+    struct TraceDiff {
+        bool sameShape;                 ///< Same frame count and frame size
+        uint8_t maxPixelError;          ///< Largest per-byte difference
+        uint32_t maxTimeError;          ///< Largest start time difference, us
+        size_t firstMismatch;           ///< First frame that is not identical, or frame count
+    };
+
+    TraceDiff compareTraces(const std::vector<Frame> &expected, const std::vector<Frame> &actual);
+}
+
+#endif // NEOSIM_H
@@ -0,0 +1,156 @@
+#include "NeoSim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace {
+    const uint8_t MAGIC[4] = {'N', 'H', 'T', '1'};
+
+    void putLE(std::vector<uint8_t> &out, uint32_t value, uint8_t size) {
+        for (uint8_t i = 0; i < size; i++)
+            out.push_back(value >> (8 * i));
+    }
+
+    void putVarint(std::vector<uint8_t> &out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(value);
+    }
+
+    struct Reader {
+        const std::vector<uint8_t> &in;
+        size_t pos;
+        bool ok;
+
+        uint32_t le(uint8_t size) {
+            uint32_t value = 0;
+            for (uint8_t i = 0; i < size; i++)
+                value |= (uint32_t) byte() << (8 * i);
+            return value;
+        }
+
+        uint32_t varint() {
+            uint32_t value = 0;
+            for (uint8_t shift = 0; shift < 35; shift += 7) {
+                uint8_t b = byte();
+                value |= (uint32_t) (b & 0x7f) << shift;
+                if (!(b & 0x80))
+                    return value;
+            }
+            ok = false;
+            return 0;
+        }
+
+        uint8_t byte() {
+            if (pos >= in.size()) {
+                ok = false;
+                return 0;
+            }
+            return in[pos++];
+        }
+    };
+}
+
+namespace neosim {
+    std::vector<uint8_t> encodeTrace(const std::vector<Frame> &frames) {
+        std::vector<uint8_t> out(MAGIC, MAGIC + sizeof(MAGIC));
+        uint16_t frameSize = frames.empty() ? 0 : frames.front().bytes.size();
+        putLE(out, frameSize, 2);
+        putLE(out, frames.size(), 4);
+
+        std::vector<uint8_t> previous(frameSize, 0);
+        uint32_t previousTime = 0;
+        for (const Frame &frame: frames) {
+            putVarint(out, frame.time - previousTime);
+            previousTime = frame.time;
+
+            size_t maskAt = out.size();
+            out.resize(out.size() + (frameSize + 7) / 8, 0);
+            for (uint16_t i = 0; i < frameSize; i++) {
+                uint8_t b = i < frame.bytes.size() ? frame.bytes[i] : 0;
+                if (b != previous[i]) {
+                    out[maskAt + i / 8] |= 1 << (i % 8);
+                    out.push_back(b);
+                    previous[i] = b;
+                }
+            }
+        }
+        return out;
+    }
+
+    bool decodeTrace(const std::vector<uint8_t> &trace, std::vector<Frame> &frames) {
+        frames.clear();
+        Reader in{trace, 0, true};
+        for (uint8_t m: MAGIC) {
+            if (in.byte() != m)
+                return false;
+        }
+        uint16_t frameSize = in.le(2);
+        uint32_t count = in.le(4);
+
+        std::vector<uint8_t> current(frameSize, 0);
+        uint32_t time = 0;
+        for (uint32_t f = 0; f < count && in.ok; f++) {
+            time += in.varint();
+            size_t maskAt = in.pos;
+            in.pos += (frameSize + 7) / 8;
+            for (uint16_t i = 0; i < frameSize && in.ok; i++) {
+                if (maskAt + i / 8 >= trace.size()) {
+                    in.ok = false;
+                } else if (trace[maskAt + i / 8] & (1 << (i % 8))) {
+                    current[i] = in.byte();
+                }
+            }
+            frames.push_back(Frame{time, current});
+        }
+        return in.ok && in.pos == trace.size();
+    }
+
+    bool writeTrace(const char *path, const std::vector<Frame> &frames) {
+        std::vector<uint8_t> trace = encodeTrace(frames);
+        FILE *file = fopen(path, "wb");
+        if (!file)
+            return false;
+        bool ok = fwrite(trace.data(), 1, trace.size(), file) == trace.size();
+        return fclose(file) == 0 && ok;
+    }
+
+    bool readTrace(const char *path, std::vector<Frame> &frames) {
+        FILE *file = fopen(path, "rb");
+        if (!file)
+            return false;
+        std::vector<uint8_t> trace;
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            trace.insert(trace.end(), chunk, chunk + n);
+        fclose(file);
+        return decodeTrace(trace, frames);
+    }
+
+    TraceDiff compareTraces(const std::vector<Frame> &expected, const std::vector<Frame> &actual) {
+        TraceDiff diff{expected.size() == actual.size(), 0, 0, expected.size()};
+        for (size_t f = 0; f < expected.size() && f < actual.size(); f++) {
+            const Frame &e = expected[f], &a = actual[f];
+            if (e.bytes.size() != a.bytes.size())
+                diff.sameShape = false;
+            bool identical = e.time == a.time && e.bytes == a.bytes;
+            if (!identical && diff.firstMismatch == expected.size())
+                diff.firstMismatch = f;
+
+            uint32_t timeError = e.time > a.time ? e.time - a.time : a.time - e.time;
+            if (timeError > diff.maxTimeError)
+                diff.maxTimeError = timeError;
+            for (size_t i = 0; i < e.bytes.size() && i < a.bytes.size(); i++) {
+                uint8_t error = abs(e.bytes[i] - a.bytes[i]);
+                if (error > diff.maxPixelError)
+                    diff.maxPixelError = error;
+            }
+        }
+        if (!diff.sameShape && diff.firstMismatch == expected.size())
+            diff.firstMismatch = expected.size() < actual.size() ? expected.size() : actual.size();
+        return diff;
+    }
+}
@@ -0,0 +1,92 @@
+#include "Waveform.h"
+
+namespace {
+    bool bitAt(const uint8_t *bytes, size_t bit) { return bytes[bit / 8] & (0x80 >> (bit % 8)); }
+
+    void appendLevel(neosim::Waveform &line, uint8_t level, uint32_t cycles) { line.insert(line.end(), cycles, level); }
+
+    uint32_t toNs(uint32_t cycles, uint32_t cpuHz) { return (uint64_t) cycles * 1000000000ULL / cpuHz; }
+}
+
+namespace neosim {
+    Waveform bitbangWaveform(const uint8_t *bytes, uint16_t numBytes) {
+        Waveform line;
+        for (size_t bit = 0; bit < numBytes * 8u; bit++) {
+            // HHxxxxxLLL
+            appendLevel(line, 1, 2);
+            appendLevel(line, bitAt(bytes, bit), 5);
+            appendLevel(line, 0, 3);
+        }
+        return line;
+    }
+
+    Waveform cclWaveform(const uint8_t *bytes, uint16_t numBytes, const CclModel &model) {
+        Waveform line;
+        uint8_t half = model.bitCycles / 2;
+        for (size_t bit = 0; bit < numBytes * 8u; bit++) {
+            bool mosi = bitAt(bytes, bit);
+            // mode 0: MOSI changes with SCK falling, SCK is low for the first
+            // half of the bit and high for the second
+            appendLevel(line, 0, model.bitCycles - half);
+            for (uint8_t c = 0; c < half; c++) {
+                bool pulse = c >= model.pulseLatency && c < model.pulseLatency + model.pulseCycles;
+                line.push_back(mosi || pulse);
+            }
+            if (bit % 8 == 7 && bit / 8 == model.stallAfterByte)
+                appendLevel(line, 0, model.stallCycles);
+        }
+        return line;
+    }
+
+    WaveformCheck checkWaveform(const Waveform &line, uint32_t cpuHz, const uint8_t *bytes, uint16_t numBytes,
+                                const BitWindows &windows) {
+        WaveformCheck check{true, 0, 0, 0, 0, 0, {UINT32_MAX, UINT32_MAX}, {0, 0}, {UINT32_MAX, UINT32_MAX}, {0, 0}};
+        size_t at = 0;
+        while (at < line.size() && !line[at])
+            at++;
+        while (at < line.size()) {
+            size_t start = at;
+            while (at < line.size() && line[at])
+                at++;
+            uint32_t highNs = toNs(at - start, cpuHz);
+            start = at;
+            while (at < line.size() && !line[at])
+                at++;
+            bool last = at == line.size();
+            uint32_t lowNs = toNs(at - start, cpuHz);
+
+            bool value = highNs > (windows.t0hMax + windows.t1hMin) / 2;
+            bool inWindow = value ? highNs >= windows.t1hMin && highNs <= windows.t1hMax
+                                  : highNs >= windows.t0hMin && highNs <= windows.t0hMax;
+            if (!last) {
+                uint32_t lowMin = value ? windows.t1lMin : windows.t0lMin;
+                uint32_t lowMax = value ? windows.t1lMax : windows.t0lMax;
+                if (lowNs >= windows.resetNs)
+                    inWindow = false;
+                else if (lowNs > lowMax)
+                    check.stretchedLows++;
+                else if (lowNs < lowMin)
+                    check.shortLows++;
+                if (lowNs < check.minLowNs[value])
+                    check.minLowNs[value] = lowNs;
+                if (lowNs > check.maxLowNs[value])
+                    check.maxLowNs[value] = lowNs;
+            }
+            if (highNs < check.minHighNs[value])
+                check.minHighNs[value] = highNs;
+            if (highNs > check.maxHighNs[value])
+                check.maxHighNs[value] = highNs;
+
+            if (!inWindow && check.outOfWindow++ == 0)
+                check.firstBad = check.bits;
+            if (check.bits >= numBytes * 8u || bitAt(bytes, check.bits) != value)
+                check.dataOk = false;
+            check.bits++;
+        }
+        if (check.bits != numBytes * 8u)
+            check.dataOk = false;
+        if (!check.outOfWindow)
+            check.firstBad = check.bits;
+        return check;
+    }
+}
@@ -0,0 +1,62 @@
+//
+// Bit-level model of the data line driven by the NeoPixel transmitters,
+// one sample per CPU cycle, and a checker for the SK6805 bit timing. It
+// stands in for a logic analyser when the transmitter timing changes.
+//
+
+#ifndef NEOSIM_WAVEFORM_H
+#define NEOSIM_WAVEFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace neosim {
+    /// Data line level, one entry per CPU cycle
+    using Waveform = std::vector<uint8_t>;
+
+    /// Timed asm loop of NeoPixel::show() at 8 MHz: 10 cycles per bit,
+    /// high for 2 cycles, then for 5 more if the bit is set
+    Waveform bitbangWaveform(const uint8_t *bytes, uint16_t numBytes);
+
+    struct CclModel {
+        uint8_t bitCycles;          ///< SPI SCK period in CPU cycles
+        uint8_t pulseCycles;        ///< TCB0 single shot length
+        uint8_t pulseLatency;       ///< Cycles from SCK rising to TCB0 output high
+        uint16_t stallAfterByte;    ///< Byte after which the SPI buffer runs dry, numBytes for none
+        uint16_t stallCycles;       ///< How long it stays dry
+    };
+
+    /// SPI mode 0 + TCB0 + CCL LUT0 (see NeoPixel/CclTransmitter.h):
+    /// DOUT = SCK & (MOSI | TCB0)
+    Waveform cclWaveform(const uint8_t *bytes, uint16_t numBytes, const CclModel &model);
+
+    struct BitWindows {
+        // SK6805 (SK6812 family) datasheet figures, +-150 ns on each
+        uint16_t t0hMin = 150, t0hMax = 450;
+        uint16_t t1hMin = 450, t1hMax = 750;
+        uint16_t t0lMin = 750, t0lMax = 1050;
+        uint16_t t1lMin = 450, t1lMax = 750;
+        uint32_t resetNs = 80000;   ///< A low this long latches the frame
+    };
+
+    struct WaveformCheck {
+        bool dataOk;                ///< Every bit decoded to the bytes sent
+        size_t bits;
+        size_t outOfWindow;         ///< Bits with a high time outside its window, or a reset
+        size_t shortLows;           ///< Lows under the window
+        size_t stretchedLows;       ///< Lows past the window but short of a reset
+        size_t firstBad;            ///< First bit out of window, or bits
+        uint32_t minHighNs[2], maxHighNs[2];   ///< Per bit value
+        uint32_t minLowNs[2], maxLowNs[2];
+    };
+
+    /// Decode the waveform bit by bit and measure it against the windows.
+    /// The high time decides what the LED reads; the low times are counted
+    /// apart, a low only breaks the frame when it is long enough for a
+    /// reset. The low after the last bit is the latch and is not measured.
+    WaveformCheck checkWaveform(const Waveform &line, uint32_t cpuHz, const uint8_t *bytes, uint16_t numBytes,
+                                const BitWindows &windows = BitWindows());
+}
+
+#endif // NEOSIM_WAVEFORM_H
@@ -0,0 +1,122 @@
+#ifndef NEOHEART_ENGINE_H
+#define NEOHEART_ENGINE_H
+
+#include <Arduino.h>
+#include <new>
+#include <string.h>
+
+#include "frameclock.h"
+
+namespace neoheart {
+// Animations are stackless coroutines: step(now) runs until the animation
+// wants to wait for its next frame and returns the frameclock deadline at which
+// it must be resumed. Everything that has to survive a wait is a member of
+// the animation, and an all-zero animation is one that has not started yet.
+// The body of step() is written like a blocking loop, with ANIM_WAIT(ms)
+// where delay(ms) would have been.
+struct Coroutine {
+    uint16_t resumeLine;  // __LINE__ of the wait to resume from, 0 = start
+    bool finished;
+
+    bool done() const { return finished; }
+};
+
+#define ANIM_BEGIN() switch (resumeLine) { case 0:
+
+// like delay(ms): the wait starts now, after the frame that was just shown
+#define ANIM_WAIT(ms)                       \
+    do {                                    \
+        resumeLine = __LINE__;              \
+        return frameclock::now() + (ms);    \
+        case __LINE__:;                     \
+    } while (0)
+
+// run another coroutine (a member of this one) until it is done
+#define ANIM_RUN(sub)                               \
+    do {                                            \
+        memset(&(sub), 0, sizeof(sub));             \
+        resumeLine = __LINE__;                      \
+        case __LINE__: {                            \
+            uint32_t next = (sub).step(now);        \
+            if (!(sub).done()) return next;         \
+        }                                           \
+    } while (0)
+
+#define ANIM_END() } finished = true; return frameclock::now()
+
+static constexpr size_t maxSize() { return 0; }
+
+template<class... Sizes>
+static constexpr size_t maxSize(size_t first, Sizes... rest) {
+    return first > maxSize(rest...) ? first : maxSize(rest...);
+}
+
+// Plays one of the given animations at a time. They share a single slot of
+// RAM, so only the state of the animation that is playing is kept. The
+// animations are plain structs: each start builds a new one over the last,
+// value-initialized, all zero.
+template<class... Animations>
+class Player {
+    using Starter = void (*)(void *slot);
+    using Stepper = bool (*)(void *slot, uint32_t now, uint32_t &deadline);
+
+    alignas(Animations...) uint8_t slot[maxSize(sizeof(Animations)...)];
+    Stepper stepper = nullptr;
+    uint32_t next = 0;
+
+    template<class Animation>
+    static void startAs(void *slot) {
+        new (slot) Animation();
+    }
+
+    template<class Animation>
+    static bool stepAs(void *slot, uint32_t now, uint32_t &deadline) {
+        Animation *animation = static_cast<Animation *>(slot);
+        deadline = animation->step(now);
+        return !animation->done();
+    }
+
+    // in flash, in the order of Animations: the index of an animation is its
+    // index in the registry of the scheduler too (schedule.h)
+    static constexpr Starter starters[] PROGMEM = {startAs<Animations>...};
+    static constexpr Stepper steppers[] PROGMEM = {stepAs<Animations>...};
+
+public:
+    static constexpr uint8_t count = sizeof...(Animations);
+
+    // start the animation at index, its first frame is due right away
+    void start(uint8_t index, uint32_t now) {
+        ((Starter) pgm_read_ptr(&starters[index]))(slot);
+        stepper = (Stepper) pgm_read_ptr(&steppers[index]);
+        next = now;
+    }
+
+    void stop() { stepper = nullptr; }
+
+    bool running() const { return stepper != nullptr; }
+
+    uint32_t deadline() const { return next; }
+
+    bool due(uint32_t now) const { return (int32_t) (now - next) >= 0; }
+
+    // advance the animation if its deadline has passed
+    void tick(uint32_t now) {
+        if (running() && due(now) && !stepper(slot, now, next))
+            stepper = nullptr;
+    }
+};
+
+// Runs an animation to the end, sleeping between frames
+template<class Animation>
+void play() {
+    Animation animation = Animation();
+    for (;;) {
+        uint32_t deadline = animation.step(frameclock::now());
+        if (animation.done())
+            return;
+        frameclock::sleepUntil(deadline);
+    }
+}
+}  // namespace neoheart
+
+#endif  // NEOHEART_ENGINE_H
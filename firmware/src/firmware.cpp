@@ -3,7 +3,6 @@
 #ifdef __AVR__
 #include <avr/interrupt.h>
 #include <avr/power.h>
-#include <avr/wdt.h>
 #include <avr/sleep.h>
 #endif
 
@@ -11,10 +10,46 @@
 #define BOOST_EN PIN_PC2
 
 using namespace neoheart;
-void enableSleep();
-void softwareReset();
-void runRandomAnim();
-void disableSleep();
+void startRandomAnim(bool underLoad = false);
+void finishAnim();
+void requestRestart();
+void powerDown();
+void stopRun();
+
+// animations picked by startRandomAnim()
+Player<Heartbeat, Bottomup, TheatherFill, Bounce, IncrementalFill, Chase, ColorWipe, Rainbow, TheaterChaseRainbow,
+       Bottomupsingle, Firework>
+        player;
+// in the order of the player; the weights fall with the cost, the cheap runs
+// come up more often
+static constexpr schedule::Entry registry[] PROGMEM = {
+        // uAh, peak mA, duration ds, weight
+        {12, 29, 24, 16},  // Heartbeat
+        {18, 20, 39, 8},   // Bottomup
+        {28, 35, 40, 6},   // TheatherFill
+        {46, 35, 83, 3},   // Bounce
+        {31, 35, 42, 6},   // IncrementalFill
+        {15, 19, 31, 7},   // Chase
+        {25, 35, 31, 8},   // ColorWipe
+        {25, 32, 30, 8},   // Rainbow
+        {50, 23, 91, 3},   // TheaterChaseRainbow
+        {27, 35, 41, 7},   // Bottomupsingle
+        {20, 23, 43, 7},   // Firework
+};
+static_assert(sizeof(registry) / sizeof(registry[0]) == decltype(player)::count, "one entry per animation");
+static_assert(schedule::weightsFit(registry), "the weights add up to a byte");
+// SUPPLY_WEAK has the lowest maxCost of the levels that allow a run
+static_assert(schedule::alwaysPicks(registry, supply::LIMITS[supply::SUPPLY_WEAK].maxCost),
+              "a run fits the budget of every press, at every supply level that allows a run");
+// what is left of the charge budget of the presses
+schedule::Scheduler scheduler;
+// set by the button, while an animation is playing or in power-down
+volatile bool restartRequested = false;
+// what the cell can take, from its voltage at every wake-up
+supply::Governor supplyGovernor;
+// frames until the next reading of the cell under load, start of the run
+uint8_t framesToCheck;
+uint32_t runStart;
 
 void setup() {
     // leds initialization
@@ -24,46 +59,116 @@ void setup() {
     // init io
     pinMode(BTN, INPUT_PULLUP);
     pinMode(BOOST_EN, OUTPUT);
-    // init random seed
-    randomSeed(analogRead(PIN_PA2));
-    // attach to interrupt
-    attachInterrupt(digitalPinToInterrupt(BTN), softwareReset, FALLING);
+    // go on with the random sequence of the last power-up, one step further
+    // in case it ends before its first save
+    rng.load();
+    rng.next();
+    rng.save();
+    // attach to interrupt: PC1 is not a fully asynchronous pin, only a change
+    // of level can wake the core from standby
+    attachInterrupt(digitalPinToInterrupt(BTN), requestRestart, CHANGE);
     // run first animation
-    runRandomAnim();
+    startRandomAnim();
 }
 
 void loop() {
-    // nothing to do here
+    if (restartRequested) {
+        // the button interrupts the animation: start over with a new one
+        restartRequested = false;
+        clearStrip();
+        startRandomAnim(true);
+    }
+    if (!player.running()) {
+        finishAnim();
+        return;
+    }
+    uint32_t now = frameclock::now();
+    if (player.due(now)) {
+        player.tick(now);
+        // a run the cell cannot hold, or longer than it can afford, ends here
+        if (--framesToCheck == 0) {
+            framesToCheck = supply::CHECK_FRAMES;
+            if (!supplyGovernor.holdsUnderLoad(supply::readMillivolts()))
+                stopRun();
+        }
+        uint16_t maxRunMs = supplyGovernor.maxRunMs();
+        if (maxRunMs && frameclock::now() - runStart >= maxRunMs)
+            stopRun();
+    } else {
+        // nothing to do until the next frame: the frame clock or the button
+        // wakes the core up from standby
+        frameclock::sleep(player.deadline());
+    }
 }
 
-void runRandomAnim(){
-    // the boost converter is enabled to power the strip until the end of the animation, then an interrupt is attached to the button and the attiny816 is put to sleep
+void startRandomAnim(bool underLoad) {
+    // the cell at rest, before the boost converter loads it: an empty one
+    // gets no run, loop() goes back to power-down. A press during a run finds
+    // the boost converter still on, the reading is one under load: it can
+    // only ask less of the next run, as a sag does
+    uint16_t millivolts = supply::readMillivolts();
+    if (underLoad)
+        supplyGovernor.holdsUnderLoad(millivolts);
+    else
+        supplyGovernor.update(millivolts);
+    if (!supplyGovernor.allowsRun()) {
+        player.stop();
+        return;
+    }
+    // the boost converter is enabled to power the strip until the end of the animation
     digitalWrite(BOOST_EN, HIGH);
-    void (*animations[])() = {heartbeat, bottomup, theatherFill, bounce, incrementalFill, chase, colorWipe, rainbow, theaterChaseRainbow};
-    int randomIndex = random(sizeof(animations) / sizeof(animations[0]));
-    animations[randomIndex]();
-    digitalWrite(BOOST_EN, LOW);
-    detachInterrupt(digitalPinToInterrupt(BTN));
-    attachInterrupt(digitalPinToInterrupt(BTN), disableSleep, CHANGE);
-    enableSleep();
+    frameclock::begin();
+    pixels.setBrightness(supplyGovernor.brightness());
+    framesToCheck = supply::CHECK_FRAMES;
+    runStart = frameclock::now();
+    player.start(scheduler.pick(registry, supplyGovernor.maxCost(), rng), runStart);
 }
 
-void softwareReset() {
-    // clear interrupts
-    cli();
-    // write in the watchdog control register
-    _PROTECTED_WRITE(WDT.CTRLA, WDT_PERIOD_8CLK_gc | WDT_WINDOW_OFF_gc);
-    // wait for the watchdog to reset the device
-    while (1);
+// end the run before the animation does, dark
+void stopRun() {
+    player.stop();
+    clearStrip();
+}
+
+void finishAnim() {
+    // the animation is over: the attiny816 is put to sleep until the button
+    // is pressed, the release of an earlier press does not count
+    digitalWrite(BOOST_EN, LOW);
+    frameclock::end();
+    // the strip is dark: a good time for the EEPROM write
+    rng.save();
+    restartRequested = false;
+    while (!restartRequested)
+        powerDown();
+    // warm resume: SRAM, the random sequence and the peripherals are as they
+    // were, the next animation starts right away
+    restartRequested = false;
+    startRandomAnim();
 }
 
-void enableSleep() {
-    sleep_enable();
-    set_sleep_mode(SLEEP_MODE_PWR_DOWN);  
-    sleep_cpu();
+void requestRestart() {
+    // the release of the button is a change too
+    if (digitalRead(BTN) == LOW)
+        restartRequested = true;
 }
 
-void disableSleep() {
-    sleep_disable();
-    softwareReset();
+void powerDown() {
+#ifdef __AVR__
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    if (!restartRequested) {
+        sleep_enable();
+        // as in frameclock::sleep(): a press between the check and the sleep
+        // still wakes the core up
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
+#else
+    // nothing left to wake the simulated core up: the button interrupt will
+    // not come either
+    if (!neosim::powerDown())
+        restartRequested = true;
+#endif
 }
@@ -1,14 +1,38 @@
 #include <Arduino.h>
 #include <NeoPixel.h>
 
+#include "engine.h"
+#include "geometry.h"
+#include "levels.h"
+#include "particles.h"
+#include "permutation.h"
+#include "rng.h"
+#include "schedule.h"
+#include "script.h"
+#include "scripts/chase.h"
+#include "supply.h"
+
 static constexpr uint8_t NEOPIXEL_PIN = PIN_PC0;
 static constexpr uint8_t NEOPIXEL_COUNT = 25;
-static constexpr double NEOPIXEL_BRIGHTNESS = 0.05;  // 5% brightness (0.05/1)
+static_assert(NEOPIXEL_COUNT == neoheart::LED_COUNT, "geometry.h describes every LED of the board");
+// Peak LED current a frame may draw, enforced by NeoPixel::show(). It comes
+// on top of the brightness cap, not instead of it: frames go out at the
+// brightness of the supply level (supply.h), at most the old 5 %, and the
+// heavy ones among them are scaled down to the budget
+static constexpr uint8_t NEOPIXEL_CURRENT_BUDGET_MA = 10;
+static constexpr uint8_t SK6805_CHANNEL_MA = 5;  // per color channel at 255
+static constexpr uint16_t NEOPIXEL_CURRENT_BUDGET = NEOPIXEL_CURRENT_BUDGET_MA * 255 / SK6805_CHANNEL_MA;
+// show() applies the brightness on the way out: the framebuffer keeps exact colors.
+static constexpr uint8_t NEOPIXEL_OPTIONS = NEO_TX_BITBANG | NEO_UNSCALED;
 
 namespace neoheart {
 // variables used internally
-NeoPixel<NEOPIXEL_COUNT, NEOPIXEL_PIN, NEO_GRB> pixels{};
+using Strip = NeoPixel<NEOPIXEL_COUNT, NEOPIXEL_PIN, NEO_GRB, NEOPIXEL_CURRENT_BUDGET, NEOPIXEL_OPTIONS>;
+// colors in wire order (Strip::Pixel), written without packing into 32 bits
+Strip pixels{};
 static constexpr int middlepixel = NEOPIXEL_COUNT / 2;
+// random colors, pixels and animations; the state survives power loss (rng.h)
+Rng rng;
 
 // initialize leds
 void initLeds() {
@@ -16,7 +40,7 @@ void initLeds() {
 }
 
 // red green blue vars used for color generation
-int r = 0, g = 0, b = 0;
+uint8_t r = 0, g = 0, b = 0;
 
 // color array
 struct Color {
@@ -29,22 +53,33 @@ struct Color {
 Color colors[] = {{0, 0, 255}, {144, 8, 255}, {255, 25, 221}, {255, 0, 0}, {255, 128, 0}, {255, 153, 0}, {8, 255, 0}, {28, 255, 142}, {31, 251, 255}, {25, 167, 255}, {115, 255, 117}};
 
 void getRandomColor() {
-    int numColors = 11;
-    long index = random(numColors);
+    uint8_t numColors = 11;
+    uint8_t index = rng.below(numColors);
     r = colors[index].r;
     g = colors[index].g;
     b = colors[index].b;
 }
 
-void paintPixel(int pixel, float brightness) {
-    pixels.setPixelColor(pixel,
-                         pixels.Color(r * brightness * NEOPIXEL_BRIGHTNESS,
-                                      g * brightness * NEOPIXEL_BRIGHTNESS,
-                                      b * brightness * NEOPIXEL_BRIGHTNESS));
+uint8_t scaleChannel(uint8_t c, uint8_t level) {
+    return (c * (uint16_t)(level + 1)) >> 8;
+}
+
+// current color scaled by level
+Strip::Pixel levelColor(uint8_t level) {
+    return Strip::Pixel(scaleChannel(r, level), scaleChannel(g, level), scaleChannel(b, level));
+}
+
+void paintPixel(int pixel, uint8_t level) {
+    pixels.setPixel(pixel, levelColor(level));
+}
+
+// paint the whole strip at the same level, the color is scaled only once
+void paintStrip(uint8_t level) {
+    pixels.fillPixels(levelColor(level));
 }
 
 void turnOffPixel(int pixel) {
-    pixels.setPixelColor(pixel, pixels.Color(0, 0, 0));
+    pixels.setPixel(pixel, Strip::Pixel());
 }
 
 void clearStrip() {
@@ -52,267 +87,452 @@ void clearStrip() {
     pixels.show();
 }
 
-void fadeOutStrip() {
-    for (int j = 0; j < 8; j++) {
-        for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-            paintPixel(i, 1 - ((float)j / (float)10));
-        }
-        pixels.show();
-        delay(20);
+// Fade steps, tails and waits of the animations, computed at compile time
+// (see levels.h): the frames themselves only look them up
+static constexpr Table<uint8_t, 11> fadeOutRamp PROGMEM = fallRamp<10>();
+static constexpr Table<uint8_t, 11> fadeInRamp PROGMEM = riseRamp<10>();
+static constexpr Table<uint8_t, NEOPIXEL_COUNT + 1> heartbeatRamp PROGMEM = riseRamp<NEOPIXEL_COUNT>();
+static constexpr Table<uint8_t, OUTLINE_ROWS> outlineRight PROGMEM = outlineSide<LOBE_RIGHT>();
+static constexpr Table<uint8_t, OUTLINE_ROWS> outlineLeft PROGMEM = outlineSide<LOBE_LEFT>();
+
+// a trail sweeping the outline rows (geometry.h), head first: the row behind
+// its tail is turned off
+static constexpr Table<uint8_t, 4> trailLevels PROGMEM = {{LEVEL_FULL, fraction(1, 2), fraction(1, 5), 0}};
+
+// paints the trail with its head on the given row, counted from the tip, or
+// from the notch going down; rows that are not on the board yet are skipped
+// by the loop bounds, so every index read from the tables is on the strip
+void paintOutlineTrail(uint8_t head, bool fromNotch) {
+    uint8_t length = head < trailLevels.size ? head + 1 : trailLevels.size;
+    for (uint8_t t = 0; t < length; t++) {
+        uint8_t row = fromNotch ? OUTLINE_ROWS - 1 - head + t : head - t;
+        Strip::Pixel color = levelColor(trailLevels.at(t));
+        pixels.setPixel(outlineRight.at(row), color);
+        pixels.setPixel(outlineLeft.at(row), color);
     }
 }
 
-void heartbeat() {
-    r = 255;
-    g = 0;
-    b = 0;
-    int animcounter = 0;
-    while (animcounter < 3) {
-        int fadeinouts = 0;
-        while (fadeinouts < 2) {
-            // fade in
-            for (int j = 1; j < NEOPIXEL_COUNT; j++) {
-                for (int i = 0; i < NEOPIXEL_COUNT; i++)
-                    paintPixel(i, ((float)j / (float)NEOPIXEL_COUNT));
-                pixels.show();
-                delay(2);
-            }
-            // fade out
-            for (int j = NEOPIXEL_COUNT; j > 0; j--) {
-                for (int i = 0; i < NEOPIXEL_COUNT; i++)
-                    paintPixel(i, ((float)j / (float)NEOPIXEL_COUNT));
-                pixels.show();
-                delay(2);
-            }
-            fadeinouts++;
-        }
-        clearStrip();
-        delay(500);
-        animcounter++;
-    }
+// bounce: the more trips, the faster the dot; entry trips is the wait in ms
+static constexpr Table<uint8_t, NEOPIXEL_COUNT + 2> bounceWaits() {
+    Table<uint8_t, NEOPIXEL_COUNT + 2> table{};
+    for (int trips = 1; trips < NEOPIXEL_COUNT + 2; trips++)
+        table.values[trips] = ((NEOPIXEL_COUNT - trips) * 4) / trips;
+    return table;
 }
+static constexpr Table<uint8_t, NEOPIXEL_COUNT + 2> bounceWait PROGMEM = bounceWaits();
 
-void bottomup() {
-    getRandomColor();
-    int animcounter = 0;
-    while (animcounter < 3) {
-        for (int i = 0; i <= NEOPIXEL_COUNT / 2; i++) {
-            turnOffPixel(middlepixel + i - 3);
-            paintPixel(middlepixel + i - 2, 0.2);
-            paintPixel(middlepixel + i - 1, 0.5);
-            paintPixel(middlepixel + i, 1);
-            turnOffPixel(middlepixel - i + 3);
-            paintPixel(middlepixel - i + 2, 0.2);
-            paintPixel(middlepixel - i + 1, 0.5);
-            paintPixel(middlepixel - i, 1);
-            pixels.show();
-            delay(30);
-        }
-        for (int i = 0; i <= NEOPIXEL_COUNT / 2; i++) {
-            turnOffPixel(i - 3);
-            paintPixel(i - 2, 0.2);
-            paintPixel(i - 1, 0.5);
-            paintPixel(i, 1);
-            turnOffPixel(NEOPIXEL_COUNT - i + 3);
-            paintPixel(NEOPIXEL_COUNT - i + 2, 0.2);
-            paintPixel(NEOPIXEL_COUNT - i + 1, 0.5);
-            paintPixel(NEOPIXEL_COUNT - i, 1);
+// Every animation below is a coroutine (see engine.h): it is played one
+// frame per step() by the Player, and the core can sleep between frames.
+
+struct FadeOut : Coroutine {
+    int8_t j;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        for (j = 0; j < 8; j++) {
+            paintStrip(fadeOutRamp.at(j));
             pixels.show();
-            delay(30);
+            ANIM_WAIT(20);
         }
-        clearStrip();
-        delay(500);
-        animcounter++;
+        ANIM_END();
     }
-}
+};
 
-void bottomupsingle() {
-    getRandomColor();
-    int randpixel = 0;
-    int animcounter = 0;
-    while (animcounter < 2) {
-        int affectedpixels[NEOPIXEL_COUNT];
-        for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-            bool duplicate = false;
-            do {
-                randpixel = random(0, NEOPIXEL_COUNT);
-                bool found = false;
-                for (int x = 0; x < NEOPIXEL_COUNT; x++) {
-                    if (randpixel == affectedpixels[x]) {
-                        found = true;
-                        break;
-                    }
+struct Heartbeat : Coroutine {
+    int8_t animcounter, fadeinouts, j;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        r = 255;
+        g = 0;
+        b = 0;
+        for (animcounter = 0; animcounter < 3; animcounter++) {
+            for (fadeinouts = 0; fadeinouts < 2; fadeinouts++) {
+                // fade in
+                for (j = 1; j < NEOPIXEL_COUNT; j++) {
+                    paintStrip(heartbeatRamp.at(j));
+                    pixels.show();
+                    ANIM_WAIT(2);
                 }
-                duplicate = found;
-            } while (duplicate);
-            if (animcounter == 0)
-                paintPixel(randpixel, 1);
-            else
-                turnOffPixel(randpixel);
-            pixels.show();
-            affectedpixels[i] = randpixel;
-            delay(60);
+                // fade out
+                for (j = NEOPIXEL_COUNT; j > 0; j--) {
+                    paintStrip(heartbeatRamp.at(j));
+                    pixels.show();
+                    ANIM_WAIT(2);
+                }
+            }
+            clearStrip();
+            ANIM_WAIT(500);
         }
-        delay(500);
-        memset(affectedpixels, 99, sizeof(affectedpixels));
-        animcounter++;
+        ANIM_END();
     }
-    clearStrip();
-}
+};
 
-void theatherFill() {
-    getRandomColor();
-    for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-        if (i % 2 == 0) {
-            paintPixel(i, 1);
-            pixels.show();
-            delay(80);
+struct Bottomup : Coroutine {
+    int8_t animcounter, i;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        getRandomColor();
+        for (animcounter = 0; animcounter < 3; animcounter++) {
+            // up both lobes from the tip, then down them from the notch
+            for (i = 0; i < OUTLINE_ROWS; i++) {
+                paintOutlineTrail(i, false);
+                pixels.show();
+                ANIM_WAIT(30);
+            }
+            for (i = 0; i < OUTLINE_ROWS; i++) {
+                paintOutlineTrail(i, true);
+                pixels.show();
+                ANIM_WAIT(30);
+            }
+            clearStrip();
+            ANIM_WAIT(500);
         }
+        ANIM_END();
     }
-    for (int i = NEOPIXEL_COUNT; i > 0; i--) {
-        if (i % 2 == 1) {
-            paintPixel(i, 1);
+};
+
+// sets the pixels to Level one at a time, in a random order: the strip
+// sparkles on, or dissolves away with Level 0
+template<uint8_t Level>
+struct Dissolve : Coroutine {
+    Permutation<NEOPIXEL_COUNT> order;
+    uint8_t i;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        order.begin(rng);
+        for (i = 0; i < NEOPIXEL_COUNT; i++) {
+            paintPixel(order.next(), Level);
             pixels.show();
-            delay(80);
+            ANIM_WAIT(60);
         }
+        ANIM_END();
     }
-    delay(200);
-    int animcounter = 0;
-    while (animcounter < 3) {
-        for (int j = 0; j < 10; j++) {
-            for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-                paintPixel(i, 1 - ((float)j / (float)10));
+};
+
+struct Bottomupsingle : Coroutine {
+    Dissolve<LEVEL_FULL> sparkle;
+    Dissolve<0> dissolve;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        getRandomColor();
+        ANIM_RUN(sparkle);
+        ANIM_WAIT(500);
+        ANIM_RUN(dissolve);
+        ANIM_WAIT(500);
+        clearStrip();
+        ANIM_END();
+    }
+};
+
+struct TheatherFill : Coroutine {
+    int8_t animcounter, i, j;
+    FadeOut fadeOut;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        getRandomColor();
+        for (i = 0; i < NEOPIXEL_COUNT; i++) {
+            if (i % 2 == 0) {
+                paintPixel(i, LEVEL_FULL);
+                pixels.show();
+                ANIM_WAIT(80);
             }
-            pixels.show();
-            delay(10);
         }
-        delay(100);
-        for (int j = 0; j < 10; j++) {
-            for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-                paintPixel(i, (float)j / (float)10);
+        for (i = NEOPIXEL_COUNT; i > 0; i--) {
+            if (i % 2 == 1) {
+                paintPixel(i, LEVEL_FULL);
+                pixels.show();
+                ANIM_WAIT(80);
             }
-            pixels.show();
-            delay(10);
         }
-        delay(100);
-        animcounter++;
+        ANIM_WAIT(200);
+        for (animcounter = 0; animcounter < 3; animcounter++) {
+            for (j = 0; j < 10; j++) {
+                paintStrip(fadeOutRamp.at(j));
+                pixels.show();
+                ANIM_WAIT(10);
+            }
+            ANIM_WAIT(100);
+            for (j = 0; j < 10; j++) {
+                paintStrip(fadeInRamp.at(j));
+                pixels.show();
+                ANIM_WAIT(10);
+            }
+            ANIM_WAIT(100);
+        }
+        ANIM_WAIT(200);
+        ANIM_RUN(fadeOut);
+        clearStrip();
+        ANIM_END();
     }
-    delay(200);
-    fadeOutStrip();
-    clearStrip();
-}
+};
 
-void bounce() {
-    getRandomColor();
-    int trips = 1;
-    while (trips < NEOPIXEL_COUNT + 1) {
-        for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-            paintPixel(i, 1);
-            turnOffPixel(i - trips);
-            pixels.show();
-            delay((NEOPIXEL_COUNT - trips) * (1 / ((float)trips / 4)));
+struct Bounce : Coroutine {
+    int8_t trips, i;
+    FadeOut fadeOut;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        getRandomColor();
+        for (trips = 1; trips < NEOPIXEL_COUNT + 1;) {
+            // the dot leaves a tail of trips pixels behind it, cut at the
+            // ends of the strip
+            for (i = 0; i < NEOPIXEL_COUNT; i++) {
+                paintPixel(i, LEVEL_FULL);
+                if (i >= trips)
+                    turnOffPixel(i - trips);
+                pixels.show();
+                ANIM_WAIT(bounceWait.at(trips));
+            }
+            trips++;
+            for (i = NEOPIXEL_COUNT - 1; i >= 0; i--) {
+                paintPixel(i, LEVEL_FULL);
+                if (i + trips < NEOPIXEL_COUNT)
+                    turnOffPixel(i + trips);
+                pixels.show();
+                ANIM_WAIT(bounceWait.at(trips));
+            }
+            trips++;
         }
-        trips++;
-        for (int i = NEOPIXEL_COUNT; i > -1; i--) {
-            paintPixel(i, 1);
-            turnOffPixel(i + trips);
-            pixels.show();
-            delay((NEOPIXEL_COUNT - trips) * (1 / ((float)trips / 4)));
+        ANIM_WAIT(1000);
+        ANIM_RUN(fadeOut);
+        clearStrip();
+        ANIM_END();
+    }
+};
+
+struct IncrementalFill : Coroutine {
+    int8_t i, j;
+    FadeOut fadeOut;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        getRandomColor();
+        for (j = 0; j <= NEOPIXEL_COUNT / 2; j++) {
+            for (i = 0; i <= NEOPIXEL_COUNT / 2; i++) {
+                paintPixel(middlepixel - i, LEVEL_FULL);
+                if ((NEOPIXEL_COUNT / 2) - i > j) turnOffPixel(middlepixel - i + 1);
+                pixels.show();
+                ANIM_WAIT(10);
+            }
+            for (i = 0; i <= NEOPIXEL_COUNT / 2; i++) {
+                paintPixel(middlepixel + i, LEVEL_FULL);
+                if (i < (NEOPIXEL_COUNT / 2) - j) turnOffPixel(middlepixel + i - 1);
+                pixels.show();
+                ANIM_WAIT(10);
+            }
         }
-        trips++;
+        ANIM_WAIT(500);
+        ANIM_RUN(fadeOut);
+        clearStrip();
+        ANIM_END();
     }
-    delay(1000);
-    fadeOutStrip();
-    clearStrip();
-}
+};
 
-void incrementalFill() {
-    getRandomColor();
-    for (int j = 0; j <= NEOPIXEL_COUNT / 2; j++) {
-        for (int i = 0; i <= NEOPIXEL_COUNT / 2; i++) {
-            paintPixel(middlepixel - i, 1);
-            if ((NEOPIXEL_COUNT / 2) - i > j) turnOffPixel(middlepixel - i + 1);
-            pixels.show();
-            delay(10);
+struct ColorWipe : Coroutine {
+    uint8_t wipes, i;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        for (wipes = 0; wipes < 3; wipes++) {
+            getRandomColor();
+            for (i = 0; i < pixels.numPixels(); i++) {
+                pixels.setPixel(i, Strip::Pixel(r, g, b));
+                pixels.show();
+                ANIM_WAIT(40);
+            }
         }
-        for (int i = 0; i <= NEOPIXEL_COUNT / 2; i++) {
-            paintPixel(middlepixel + i, 1);
-            if (i < (NEOPIXEL_COUNT / 2) - j) turnOffPixel(middlepixel + i - 1);
+        clearStrip();
+        ANIM_END();
+    }
+};
+
+struct Rainbow : Coroutine {
+    int32_t firstPixelHue;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        for (firstPixelHue = 0; firstPixelHue < 2 * 65536; firstPixelHue += 256) {
+            pixels.rainbow(firstPixelHue);
             pixels.show();
-            delay(10);
+            ANIM_WAIT(5);
         }
+        clearStrip();
+        ANIM_END();
     }
-    delay(500);
-    fadeOutStrip();
-    clearStrip();
-}
+};
+
+struct TheaterChaseRainbow : Coroutine {
+    uint8_t a, phase;
+    uint16_t firstPixelHue;
 
-void chase() {
-    getRandomColor();
-    int p = 0;
-    int currentPixel;
-    for (int i = 0; i < (NEOPIXEL_COUNT * 3) + 1; i++) {
-        currentPixel = i % NEOPIXEL_COUNT;
-        p = currentPixel - 5 >= 0 ? currentPixel - 5 : (currentPixel - 5) + NEOPIXEL_COUNT;
-        turnOffPixel(p);
-        p = currentPixel - 4 >= 0 ? currentPixel - 4 : (currentPixel - 4) + NEOPIXEL_COUNT;
-        paintPixel(p, 0.1);
-        p = currentPixel - 3 >= 0 ? currentPixel - 3 : (currentPixel - 3) + NEOPIXEL_COUNT;
-        paintPixel(p, 0.2);
-        p = currentPixel - 2 >= 0 ? currentPixel - 2 : (currentPixel - 2) + NEOPIXEL_COUNT;
-        paintPixel(p, 0.4);
-        p = currentPixel - 1 >= 0 ? currentPixel - 1 : (currentPixel - 1) + NEOPIXEL_COUNT;
-        paintPixel(p, 0.6);
-        paintPixel(currentPixel, 1);
-        pixels.show();
-        delay(40);
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        for (a = 0; a < 30; a++) {
+            for (phase = 0; phase < 3; phase++) {
+                pixels.clear();
+                for (int c = phase; c < pixels.numPixels(); c += 3) {
+                    uint16_t hue = firstPixelHue + Strip::pixelHue(c);
+                    pixels.setPixel(c, Strip::PixelHueGamma((uint16_t) (hue + 128) >> 8));
+                }
+                pixels.show();
+                ANIM_WAIT(100);
+                firstPixelHue += 65536 / 15;
+            }
+        }
+        clearStrip();
+        ANIM_END();
     }
-    clearStrip();
-}
+};
+
+// a rocket climbs a lobe from the tip, leaving sparks behind, and bursts into
+// particles that slow down and fade, three times
+struct Firework : Coroutine {
+    static constexpr uint8_t FRAME_MS = 20;
+    static constexpr int16_t ROCKET_SPEED = 128;  // half a pixel a frame
+    static constexpr uint8_t SPARK_LIFE = 6;
+    static constexpr uint8_t BURST_DRAG = 4;
+    static constexpr uint8_t PALETTE = sizeof(colors) / sizeof(colors[0]);
 
-void colorWipeColor(uint32_t color, int wait) {
-    for (int i = 0; i < pixels.numPixels(); i++) {
-        pixels.setPixelColor(i, color);
-        pixels.show();
-        delay(wait);
+    ParticlePool<> pool;
+    uint8_t shots, color, rocket;
+
+    // a particle of the palette of the animations, at full level
+    static Strip::Pixel shade(uint8_t index) {
+        return Strip::Pixel(colors[index].r, colors[index].g, colors[index].b);
     }
-}
 
-void colorWipe() {
-    pixels.setBrightness(255 / (1 / NEOPIXEL_BRIGHTNESS));
-    for(int i = 0; i < 3; i++){
-        getRandomColor();
-        colorWipeColor(pixels.Color(r, g, b), 40);
+    // every slot a particle flying off either way, half of them in the color
+    // of the rocket
+    void burst(int16_t at) {
+        pool.clear();
+        for (uint8_t i = 0; i < pool.CAPACITY; i++) {
+            int16_t speed = 32 + rng.below(160);
+            pool.spawn(at, i & 1 ? speed : -speed, i & 2 ? rng.below(PALETTE) : color, 24 + rng.below(16));
+        }
     }
-    clearStrip();
-}
 
-void rainbow() {
-    pixels.setBrightness(255 / (1 / NEOPIXEL_BRIGHTNESS));
-    for (long firstPixelHue = 0; firstPixelHue < 2 * 65536; firstPixelHue += 256) {
-        pixels.rainbow(firstPixelHue);
-        pixels.show();
-        delay(5);
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        for (shots = 0; shots < 3; shots++) {
+            color = rng.below(PALETTE);
+            rocket = pool.spawn(TIP_LED << 8, rng.below(2) ? ROCKET_SPEED : -ROCKET_SPEED, color,
+                                12 + rng.below(12));
+            // the rocket's last frame: its sparks give way to the burst
+            while (pool.particles[rocket].life > 1) {
+                pool.spawn(pool.particles[rocket].position, 0, color, SPARK_LIFE);
+                pixels.clear();
+                pool.frame(pixels, shade, NEOPIXEL_COUNT, 0);
+                pixels.show();
+                ANIM_WAIT(FRAME_MS);
+            }
+            burst(pool.particles[rocket].position);
+            while (pool.alive()) {
+                pixels.clear();
+                pool.frame(pixels, shade, NEOPIXEL_COUNT, BURST_DRAG);
+                pixels.show();
+                ANIM_WAIT(FRAME_MS);
+            }
+            ANIM_WAIT(300);
+        }
+        clearStrip();
+        ANIM_END();
     }
-    clearStrip();
-}
+};
+
+// Plays a compiled animation script (see script.h) stored in flash
+template<const uint8_t *Program>
+struct Script : Coroutine {
+    uint16_t pc;
+    uint8_t fadeStep;
+    uint8_t depth;
+    uint16_t loopStart[SCRIPT_LOOP_DEPTH];
+    uint8_t loopLeft[SCRIPT_LOOP_DEPTH];
+
+    static uint8_t byteAt(uint16_t at) { return pgm_read_byte(Program + at); }
+
+    // the buffer holds unscaled colors, rotating it moves them as they are
+    static void shiftStrip(int8_t n) { pixels.rotatePixels(n); }
 
-void theaterChaseRainbow() {
-    pixels.setBrightness(255 / (1 / NEOPIXEL_BRIGHTNESS));
-    int firstPixelHue = 0;
-    for (int a = 0; a < 30; a++) {
-        for (int b = 0; b < 3; b++) {
-            pixels.clear();
-            for (int c = b; c < pixels.numPixels(); c += 3) {
-                int hue = firstPixelHue + c * 65536L / pixels.numPixels();
-                uint32_t color = pixels.gamma32(pixels.ColorHSV(hue));
-                pixels.setPixelColor(c, color);
+    uint32_t step(uint32_t now) {
+        for (;;) {
+            switch (byteAt(pc)) {
+                case OP_COLOR:
+                    r = byteAt(pc + 1);
+                    g = byteAt(pc + 2);
+                    b = byteAt(pc + 3);
+                    pc += 4;
+                    break;
+                case OP_RANDOM:
+                    getRandomColor();
+                    pc += 1;
+                    break;
+                case OP_SET:
+                    paintPixel(byteAt(pc + 1), byteAt(pc + 2));
+                    pc += 3;
+                    break;
+                case OP_FILL:
+                    paintStrip(byteAt(pc + 1));
+                    pc += 2;
+                    break;
+                case OP_CLEAR:
+                    pixels.clear();
+                    pc += 1;
+                    break;
+                case OP_SHIFT:
+                    shiftStrip((int8_t) byteAt(pc + 1));
+                    pc += 2;
+                    break;
+                case OP_SHOW:
+                    pixels.show();
+                    pc += 1;
+                    break;
+                case OP_WAIT: {
+                    uint16_t ms = byteAt(pc + 1) | (byteAt(pc + 2) << 8);
+                    pc += 3;
+                    return frameclock::now() + ms;
+                }
+                case OP_FADE: {
+                    // one frame per step(): pc stays on the FADE until its last frame
+                    uint8_t from = byteAt(pc + 1), to = byteAt(pc + 2), steps = byteAt(pc + 3);
+                    uint8_t ms = byteAt(pc + 4);
+                    fadeStep++;
+                    uint8_t delta = to > from ? to - from : from - to;
+                    uint8_t offset = ((uint16_t) delta * fadeStep) / steps;
+                    paintStrip(to > from ? from + offset : from - offset);
+                    pixels.show();
+                    if (fadeStep == steps) {
+                        fadeStep = 0;
+                        pc += 5;
+                    }
+                    return frameclock::now() + ms;
+                }
+                case OP_LOOP:
+                    loopStart[depth] = pc + 2;
+                    loopLeft[depth] = byteAt(pc + 1);
+                    depth++;
+                    pc += 2;
+                    break;
+                case OP_NEXT:
+                    if (--loopLeft[depth - 1]) {
+                        pc = loopStart[depth - 1];
+                    } else {
+                        depth--;
+                        pc += 1;
+                    }
+                    break;
+                default:  // OP_END
+                    finished = true;
+                    return frameclock::now();
             }
-            pixels.show();
-            delay(100);
-            firstPixelHue += 65536 / 15;
         }
     }
-    clearStrip();
-}
+};
+
+// chase: a head with a fading tail running around the heart three times
+using Chase = Script<chaseScript>;
 }  // namespace neoheart
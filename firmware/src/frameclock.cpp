@@ -0,0 +1,92 @@
+#include "frameclock.h"
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+namespace {
+    // the RTC counts 1024 ticks per second, every tick is 125/128 ms; the
+    // overflows, every 64 s, extend its 16 bits
+    volatile uint16_t overflows = 0;
+
+    // with interrupts off: an overflow not yet counted by the ISR is pending
+    uint32_t ticks() {
+        uint16_t count = RTC.CNT;
+        uint16_t high = overflows;
+        if ((RTC.INTFLAGS & RTC_OVF_bm) && count < 0x8000)
+            high++;
+        return (uint32_t) high << 16 | count;
+    }
+
+    uint32_t ticksToMs(uint32_t ticks) { return (ticks >> 7) * 125 + (((uint8_t) ticks & 127) * 125U >> 7); }
+}
+
+// the compare match only wakes the core up
+ISR(RTC_CNT_vect) {
+    uint8_t flags = RTC.INTFLAGS;
+    RTC.INTFLAGS = flags;
+    if (flags & RTC_OVF_bm)
+        overflows++;
+}
+
+namespace neoheart {
+namespace frameclock {
+void begin() {
+    // the 32 kHz ULP oscillator is always available and runs in every sleep mode
+    while (RTC.STATUS > 0);
+    RTC.CLKSEL = RTC_CLKSEL_INT32K_gc;
+    RTC.PER = 0xffff;
+    RTC.INTCTRL = RTC_OVF_bm | RTC_CMP_bm;
+    RTC.CTRLA = RTC_PRESCALER_DIV32_gc | RTC_RUNSTDBY_bm | RTC_RTCEN_bm;
+}
+
+void end() {
+    while (RTC.STATUS > 0);
+    RTC.CTRLA = 0;
+    RTC.INTCTRL = 0;
+}
+
+uint32_t now() {
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t t = ticks();
+    SREG = sreg;
+    return ticksToMs(t);
+}
+
+void sleep(uint32_t deadline) {
+    set_sleep_mode(SLEEP_MODE_STANDBY);
+    cli();
+    uint32_t t = ticks();
+    int32_t ahead = deadline - ticksToMs(t);
+    if (ahead > 0) {
+        if (ahead > MAX_SLEEP_MS)
+            ahead = MAX_SLEEP_MS;
+        // the first tick at or past the deadline
+        uint16_t wait = ((uint16_t) ahead * 128U + 124) / 125;
+        uint16_t target = (uint16_t) t + wait;
+        while (RTC.STATUS & RTC_CMPBUSY_bm);
+        RTC.CMP = target;
+        // the compare value reaches the RTC a few 32 kHz cycles later: a
+        // match on the next tick could be missed, and the one after would
+        // be 64 s away
+        bool matches = true;
+        if (wait < 2) {
+            while (RTC.STATUS & RTC_CMPBUSY_bm);
+            matches = (int16_t) (target - (uint16_t) ticks()) > 0;
+        }
+        if (matches) {
+            sleep_enable();
+            // the instruction after sei is executed before any pending
+            // interrupt, so a match cannot slip in between the check and
+            // the sleep
+            sei();
+            sleep_cpu();
+            sleep_disable();
+        }
+    }
+    sei();
+}
+}  // namespace frameclock
+}  // namespace neoheart
+#endif
@@ -0,0 +1,70 @@
+#ifndef NEOHEART_FRAMECLOCK_H
+#define NEOHEART_FRAMECLOCK_H
+
+#include <Arduino.h>
+
+#ifndef __AVR__
+#include <NeoSim.h>
+#endif
+
+// Frame timing for the animations. On the board the time base is the RTC
+// counter, clocked by the 32 kHz internal oscillator, which keeps running
+// while the core is in standby: between two frames the core sleeps instead
+// of spinning in delay(), and the compare match at the next deadline wakes
+// it up once per frame. millis() stops in standby, so everything that
+// schedules frames reads frameclock::now() instead.
+namespace neoheart {
+namespace frameclock {
+// longest sleep: the deadline is converted to ticks in 16 bits, a longer
+// hold wakes the core up every MAX_SLEEP_MS and goes back to sleep
+static constexpr uint16_t MAX_SLEEP_MS = 511;
+// time awake for a wake-up from standby beyond the frame itself, an
+// estimate from cycle counts at 8 MHz: the start-up of the main clock, the
+// RTC interrupt and the compare value of the next sleep, with its 16-bit
+// division
+static constexpr uint16_t WAKE_US = 60;
+
+#ifdef __AVR__
+// start the RTC counter (1024 Hz); the clock keeps its count across
+// end()/begin()
+void begin();
+
+// stop the RTC counter so it does not wake the core from power-down
+void end();
+
+// milliseconds counted by the RTC
+uint32_t now();
+
+// sleep in standby until deadline, at most MAX_SLEEP_MS, unless it has
+// passed: the caller gets control back on every wake-up, the button included
+void sleep(uint32_t deadline);
+#else
+inline void begin() {}
+
+inline void end() {}
+
+inline uint32_t now() { return millis(); }
+
+// the core sleeps until the deadline, as on the board; NeoSim keeps count of
+// the time spent asleep, everything else is time the core is awake, the
+// WAKE_US of every wake-up included
+inline void sleep(uint32_t deadline) {
+    int32_t wait = deadline - millis();
+    if (wait > 0) {
+        if (wait > MAX_SLEEP_MS)
+            wait = MAX_SLEEP_MS;
+        neosim::sleep(wait * 1000UL - WAKE_US);
+        neosim::advance(WAKE_US);
+    }
+}
+#endif
+
+// sleep until deadline, whatever wakes the core up in the meantime
+inline void sleepUntil(uint32_t deadline) {
+    while ((int32_t) (now() - deadline) < 0)
+        sleep(deadline);
+}
+}  // namespace frameclock
+}  // namespace neoheart
+
+#endif  // NEOHEART_FRAMECLOCK_H
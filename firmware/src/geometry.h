@@ -0,0 +1,155 @@
+#ifndef NEOHEART_GEOMETRY_H
+#define NEOHEART_GEOMETRY_H
+
+#include <Arduino.h>
+
+#include "levels.h"
+
+// Where the LEDs are on the heart, from neoheart_v2.kicad_pcb, so that the
+// animations can walk the board by shape instead of by index arithmetic on
+// the data chain. Everything here is worked out by the compiler; the
+// animations only read the resulting index tables.
+namespace neoheart {
+static constexpr uint8_t LED_COUNT = 25;
+
+// 0.1 mm units as in the PCB's front view: x from the axis of the heart,
+// positive on the right lobe, y up from the tip
+struct LedPosition {
+    int16_t x;
+    int16_t y;
+};
+
+// in data chain order, D1 gets the data first
+static constexpr LedPosition ledPositions[LED_COUNT] = {
+        {30, 342},    //  0 D1, right of the notch
+        {71, 384},    //  1 D4
+        {122, 403},   //  2 D7
+        {174, 398},   //  3 D10
+        {218, 366},   //  4 D13
+        {238, 321},   //  5 D16
+        {241, 272},   //  6 D18
+        {219, 223},   //  7 D20
+        {180, 174},   //  8 D22
+        {136, 131},   //  9 D24
+        {92, 88},     // 10 D2
+        {46, 44},     // 11 D5
+        {0, 0},       // 12 D8, the tip
+        {-45, 44},    // 13 D11
+        {-91, 88},    // 14 D14
+        {-135, 131},  // 15 D17
+        {-180, 174},  // 16 D19
+        {-219, 223},  // 17 D21
+        {-238, 272},  // 18 D23
+        {-237, 321},  // 19 D25
+        {-218, 366},  // 20 D3
+        {-172, 398},  // 21 D6
+        {-121, 403},  // 22 D9
+        {-70, 384},   // 23 D12
+        {-30, 342},   // 24 D15, left of the notch
+};
+
+enum Lobe : uint8_t { LOBE_LEFT, LOBE_CENTER, LOBE_RIGHT };
+
+constexpr Lobe lobeOf(uint8_t led) {
+    return ledPositions[led].x > 0 ? LOBE_RIGHT : ledPositions[led].x < 0 ? LOBE_LEFT : LOBE_CENTER;
+}
+
+constexpr int16_t topHeight() {
+    int16_t top = 0;
+    for (uint8_t led = 0; led < LED_COUNT; led++)
+        if (ledPositions[led].y > top)
+            top = ledPositions[led].y;
+    return top;
+}
+
+// horizontal bands of equal height, 0 at the tip
+static constexpr uint8_t HEIGHT_BANDS = 5;
+
+constexpr uint8_t bandOf(uint8_t led) {
+    return (int32_t) ledPositions[led].y * HEIGHT_BANDS / (topHeight() + 1);
+}
+
+// the LED closest to where this one would be mirrored on the other lobe
+constexpr uint8_t mirrorOf(uint8_t led) {
+    uint8_t nearest = led;
+    int32_t nearestDistance = INT32_MAX;
+    for (uint8_t other = 0; other < LED_COUNT; other++) {
+        int32_t dx = ledPositions[other].x + ledPositions[led].x;
+        int32_t dy = ledPositions[other].y - ledPositions[led].y;
+        if (dx * dx + dy * dy < nearestDistance) {
+            nearest = other;
+            nearestDistance = dx * dx + dy * dy;
+        }
+    }
+    return nearest;
+}
+
+constexpr uint8_t tipLed() {
+    uint8_t tip = 0;
+    for (uint8_t led = 1; led < LED_COUNT; led++)
+        if (ledPositions[led].y < ledPositions[tip].y)
+            tip = led;
+    return tip;
+}
+
+static constexpr uint8_t TIP_LED = tipLed();
+
+// The outline seen as rows of mirrored pairs: row 0 is the tip, row k the
+// two LEDs k places along the chain from it, one per lobe, up to the pair
+// either side of the notch. The chain runs round the outline from the notch
+// to the notch, so each side of a row is one table read.
+static constexpr uint8_t OUTLINE_ROWS = LED_COUNT / 2 + 1;
+
+template<Lobe Side>
+constexpr Table<uint8_t, OUTLINE_ROWS> outlineSide() {
+    Table<uint8_t, OUTLINE_ROWS> table{};
+    for (uint8_t row = 0; row < OUTLINE_ROWS; row++)
+        table.values[row] = Side == LOBE_RIGHT ? TIP_LED - row : TIP_LED + row;
+    return table;
+}
+
+// every LED, from the tip up; LEDs at the same height in chain order
+constexpr Table<uint8_t, LED_COUNT> heightOrder() {
+    Table<uint8_t, LED_COUNT> table{};
+    bool taken[LED_COUNT] = {};
+    for (uint8_t i = 0; i < LED_COUNT; i++) {
+        uint8_t lowest = LED_COUNT;
+        for (uint8_t led = 0; led < LED_COUNT; led++)
+            if (!taken[led] && (lowest == LED_COUNT || ledPositions[led].y < ledPositions[lowest].y))
+                lowest = led;
+        taken[lowest] = true;
+        table.values[i] = lowest;
+    }
+    return table;
+}
+
+// checks on the tables, so that walking them needs no bounds checks
+template<uint16_t Size>
+constexpr bool isPermutation(const Table<uint8_t, Size> &table) {
+    bool seen[LED_COUNT] = {};
+    for (uint16_t i = 0; i < Size; i++) {
+        if (table.values[i] >= LED_COUNT || seen[table.values[i]])
+            return false;
+        seen[table.values[i]] = true;
+    }
+    return Size == LED_COUNT;
+}
+
+constexpr bool outlineIsMirrored() {
+    for (uint8_t row = 0; row < OUTLINE_ROWS; row++) {
+        uint8_t right = outlineSide<LOBE_RIGHT>().values[row], left = outlineSide<LOBE_LEFT>().values[row];
+        if (right >= LED_COUNT || left >= LED_COUNT || mirrorOf(right) != left)
+            return false;
+        if (row > 0 && (lobeOf(right) != LOBE_RIGHT || lobeOf(left) != LOBE_LEFT))
+            return false;
+    }
+    return true;
+}
+
+static_assert(TIP_LED == LED_COUNT / 2, "The chain starts and ends at the notch, the tip is halfway");
+static_assert(lobeOf(TIP_LED) == LOBE_CENTER, "The tip is on the axis");
+static_assert(outlineIsMirrored(), "Outline rows pair each LED with its mirror on the other lobe");
+static_assert(isPermutation(heightOrder()), "Every LED comes up once going up the heart");
+}  // namespace neoheart
+
+#endif  // NEOHEART_GEOMETRY_H
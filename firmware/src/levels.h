@@ -0,0 +1,55 @@
+#ifndef NEOHEART_LEVELS_H
+#define NEOHEART_LEVELS_H
+
+#include <Arduino.h>
+
+namespace neoheart {
+// levels are Q8 fixed point: 0 = off, 255 = full. Scaling is an 8x8 bit
+// multiply keeping the high byte, so no float code ends up on the hot path
+static constexpr uint8_t LEVEL_FULL = 255;
+
+// level for the fraction num / den, only meant for constant expressions
+static constexpr uint8_t fraction(uint16_t num, uint16_t den) {
+    return (num * LEVEL_FULL) / den;
+}
+
+// A table computed by the compiler and kept in flash, like the sine and
+// gamma tables of NeoPixel.h: declare it PROGMEM and read it with at().
+template<class T, uint16_t Size>
+struct Table {
+    static_assert(sizeof(T) <= 2, "Only byte and word tables can be read from flash");
+
+    T values[Size];
+
+    static constexpr uint16_t size = Size;
+
+    T at(uint16_t i) const {
+        if (sizeof(T) == 1)
+            return (T) pgm_read_byte(&values[i]);
+        return (T) pgm_read_word(&values[i]);
+    }
+};
+
+// level rising from off to full in Steps steps: entry i is i / Steps
+template<uint8_t Steps>
+constexpr Table<uint8_t, Steps + 1> riseRamp() {
+    Table<uint8_t, Steps + 1> table{};
+    for (uint16_t i = 0; i <= Steps; i++)
+        table.values[i] = (i * LEVEL_FULL) / Steps;
+    return table;
+}
+
+// level falling from full to off in Steps steps: entry i is 1 - i / Steps
+template<uint8_t Steps>
+constexpr Table<uint8_t, Steps + 1> fallRamp() {
+    Table<uint8_t, Steps + 1> table{};
+    for (uint16_t i = 0; i <= Steps; i++)
+        table.values[i] = LEVEL_FULL - (i * LEVEL_FULL) / Steps;
+    return table;
+}
+
+static_assert(riseRamp<10>().values[10] == LEVEL_FULL, "A rise ends at full level");
+static_assert(fallRamp<10>().values[10] == 0, "A fall ends off");
+}  // namespace neoheart
+
+#endif  // NEOHEART_LEVELS_H
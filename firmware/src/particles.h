@@ -0,0 +1,100 @@
+#ifndef NEOHEART_PARTICLES_H
+#define NEOHEART_PARTICLES_H
+
+#include <Arduino.h>
+#include <string.h>
+
+// Particles along the chain for sparks, comets and fireworks: a pool of a
+// size fixed at compile time, kept in the animation that uses it (the slot
+// of the Player, engine.h), never on the heap. Positions and velocities are
+// 8.8 fixed point, in pixels and pixels per frame, so a particle moves by
+// fractions of a pixel and is drawn between the two pixels it is over.
+namespace neoheart {
+// SRAM a particle effect may take for its pool, out of the 512 bytes of the
+// ATtiny816: the Player slot is as large as its largest animation
+static constexpr uint8_t PARTICLE_RAM = 48;
+// frames over which a particle fades out at the end of its life
+static constexpr uint8_t PARTICLE_FADE_SHIFT = 4;
+
+struct Particle {
+    int16_t position;  // 8.8 pixels along the chain
+    int16_t velocity;  // 8.8 pixels per frame
+    uint8_t color;     // index in the palette of the effect
+    uint8_t life;      // frames left, 0 for a free slot
+};
+
+template<uint8_t Capacity = PARTICLE_RAM / sizeof(Particle)>
+struct ParticlePool {
+    static_assert(Capacity > 0 && Capacity * sizeof(Particle) <= PARTICLE_RAM, "the pool fits PARTICLE_RAM");
+    static constexpr uint8_t CAPACITY = Capacity;
+    static constexpr uint8_t NONE = 0xff;
+
+    // all zero, as the Player leaves it, is an empty pool
+    Particle particles[Capacity];
+
+    // a new particle in a free slot, its index or NONE if the pool is full
+    uint8_t spawn(int16_t position, int16_t velocity, uint8_t color, uint8_t life) {
+        for (uint8_t i = 0; i < Capacity; i++)
+            if (!particles[i].life) {
+                particles[i] = {position, velocity, color, life};
+                return i;
+            }
+        return NONE;
+    }
+
+    void clear() { memset(particles, 0, sizeof(particles)); }
+
+    uint8_t alive() const {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < Capacity; i++)
+            count += particles[i].life != 0;
+        return count;
+    }
+
+    // one frame on: every particle moves by its velocity, which drag slows
+    // down by 1/2^dragShift (0 for none), and ages; a particle is gone at
+    // the end of its life or off the first length pixels
+    void step(uint8_t length, uint8_t dragShift) {
+        for (uint8_t i = 0; i < Capacity; i++) {
+            Particle &p = particles[i];
+            if (!p.life)
+                continue;
+            p.position += p.velocity;
+            // rounded toward 0 either way, so that bursts do not drift: a
+            // plain shift rounds negative velocities down
+            if (dragShift)
+                p.velocity -= p.velocity < 0 ? -(-p.velocity >> dragShift) : p.velocity >> dragShift;
+            if (--p.life && (uint16_t) p.position >= (uint16_t) length << 8)
+                p.life = 0;
+        }
+    }
+
+    // adds every particle to the strip, its color from shade(index) at the
+    // level of its age, split between the pixel it is over and the next one
+    // by the fraction of its position
+    template<class Strip, class Shade>
+    void render(Strip &strip, Shade shade) const {
+        for (uint8_t i = 0; i < Capacity; i++) {
+            const Particle &p = particles[i];
+            if (!p.life)
+                continue;
+            uint8_t level = p.life >= (1 << PARTICLE_FADE_SHIFT) ? 255 : p.life << PARTICLE_FADE_SHIFT;
+            uint8_t pixel = p.position >> 8;
+            uint8_t fraction = p.position;
+            auto color = shade(p.color);
+            strip.addPixel(pixel, color, (level * (uint16_t) (256 - fraction)) >> 8);
+            if (fraction)
+                strip.addPixel(pixel + 1, color, (level * (uint16_t) (fraction + 1)) >> 8);
+        }
+    }
+
+    // a frame of an effect: step(), then render()
+    template<class Strip, class Shade>
+    void frame(Strip &strip, Shade shade, uint8_t length, uint8_t dragShift) {
+        step(length, dragShift);
+        render(strip, shade);
+    }
+};
+}  // namespace neoheart
+
+#endif  // NEOHEART_PARTICLES_H
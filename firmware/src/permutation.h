@@ -0,0 +1,96 @@
+#ifndef NEOHEART_PERMUTATION_H
+#define NEOHEART_PERMUTATION_H
+
+#include <Arduino.h>
+
+#include "levels.h"
+#include "rng.h"
+
+// Random orders of the pixels without a list of the pixels already visited:
+// a maximal-length LFSR steps through every non-zero state of its width once
+// per period, so its states, the ones past the count skipped, are a
+// permutation of 1 to Count kept in three bytes. A right-shifting LFSR
+// follows every even state with its half, so the states are whitened by a
+// random mask before they are used.
+namespace neoheart {
+// smallest LFSR width whose period, 2^width - 1, covers count
+static constexpr uint8_t lfsrWidth(uint8_t count) {
+    uint8_t width = 2;
+    while (((1u << width) - 1) < count)
+        width++;
+    return width;
+}
+
+// Galois LFSR, shifting right: the taps are xored in when a one falls out
+static constexpr uint8_t lfsrStep(uint8_t state, uint8_t taps) {
+    return (state & 1) ? (state >> 1) ^ taps : state >> 1;
+}
+
+// the taps visit every non-zero state of width before coming back to 1
+static constexpr bool isMaximal(uint8_t taps, uint8_t width) {
+    uint16_t period = 0;
+    uint8_t state = 1;
+    do {
+        state = lfsrStep(state, taps);
+        period++;
+    } while (state != 1 && period < 256);
+    return period == (1u << width) - 1;
+}
+
+// maximal taps of width: the top bit is set, so every state stays in width
+template<uint8_t Width>
+constexpr uint8_t maximalTapCount() {
+    uint8_t count = 0;
+    for (uint16_t taps = 1u << (Width - 1); taps < (1u << Width); taps++)
+        if (isMaximal(taps, Width))
+            count++;
+    return count;
+}
+
+template<uint8_t Width>
+constexpr Table<uint8_t, maximalTapCount<Width>()> maximalTaps() {
+    Table<uint8_t, maximalTapCount<Width>()> table{};
+    uint8_t i = 0;
+    for (uint16_t taps = 1u << (Width - 1); taps < (1u << Width); taps++)
+        if (isMaximal(taps, Width))
+            table.values[i++] = taps;
+    return table;
+}
+
+// Visits 0 to Count - 1, each once in Count calls of next(), in one of
+// (2^width - 1)^2 * maximalTapCount orders picked by begin(): 5766 of them
+// for the 25 pixels of the board. An all-zero Permutation has not begun.
+template<uint8_t Count>
+struct Permutation {
+    static_assert(Count >= 1, "something to visit");
+    static constexpr uint8_t WIDTH = lfsrWidth(Count);
+    static constexpr uint8_t PERIOD = (1u << WIDTH) - 1;
+    static constexpr Table<uint8_t, maximalTapCount<WIDTH>()> TAPS PROGMEM = maximalTaps<WIDTH>();
+
+    uint8_t state;
+    uint8_t taps;
+    uint8_t mask;
+
+    // a random order, starting anywhere in the sequence of random taps,
+    // under a random mask
+    void begin(Rng &rng) {
+        taps = TAPS.at(rng.below(TAPS.size));
+        state = 1 + rng.below(PERIOD);
+        mask = 1 + rng.below(PERIOD);
+    }
+
+    // state ^ mask, but the state equal to the mask, which would give 0,
+    // gives the mask instead: still 1 to PERIOD, each once a period. The
+    // values past Count are skipped, at most PERIOD - Count of them a period
+    uint8_t next() {
+        uint8_t value;
+        do {
+            state = lfsrStep(state, taps);
+            value = state == mask ? mask : state ^ mask;
+        } while (value > Count);
+        return value - 1;
+    }
+};
+}  // namespace neoheart
+
+#endif  // NEOHEART_PERMUTATION_H
@@ -0,0 +1,73 @@
+#ifndef NEOHEART_RNG_H
+#define NEOHEART_RNG_H
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+#include <avr/eeprom.h>
+#endif
+
+// Random numbers for the animations: a 16-bit xorshift whose state is kept in
+// EEPROM, so the board goes on with its sequence after the battery has been
+// out instead of seeding from a floating ADC pin on every boot.
+namespace neoheart {
+// The state is saved round-robin over SLOTS slots, each with a one-byte
+// sequence number (Atmel AVR101): the last slot written is the one whose
+// successor does not continue the sequence. A slot is written once every
+// SLOTS saves; the state goes in before its sequence number, so a save cut
+// short by a power loss leaves the previous state current.
+struct Rng {
+    static constexpr uint8_t SLOTS = 16;
+    static constexpr uint8_t EEPROM_BASE = 0;  // SLOTS words of state, then SLOTS sequence bytes
+
+    uint16_t state = 1;
+
+    // xorshift16 with Marsaglia's (7, 9, 8) triple: every non-zero state, 65535
+    // of them, comes up once per period
+    uint16_t next() {
+        state ^= state << 7;
+        state ^= state >> 9;
+        state ^= state << 8;
+        return state;
+    }
+
+    // 0 to n - 1 as the high word of a 16x8-bit multiply, instead of the
+    // 32-bit division of random(): each value is hit 65535 / n times a period,
+    // give or take one
+    uint8_t below(uint8_t n) { return ((uint32_t) next() * n) >> 16; }
+
+    void load() {
+        uint16_t saved = eeprom_read_word(stateAt(current()));
+        // erased EEPROM reads as 0xffff, fine as a seed; 0 is the one state
+        // xorshift cannot leave
+        state = saved ? saved : 1;
+    }
+
+    void save() {
+        uint8_t slot = current();
+        uint8_t sequence = eeprom_read_byte(sequenceAt(slot)) + 1;
+        slot = (slot + 1) % SLOTS;
+        eeprom_update_word(stateAt(slot), state);
+        eeprom_update_byte(sequenceAt(slot), sequence);
+    }
+
+private:
+    static uint16_t *stateAt(uint8_t slot) { return (uint16_t *) (uintptr_t) (EEPROM_BASE + 2 * slot); }
+
+    static uint8_t *sequenceAt(uint8_t slot) { return (uint8_t *) (uintptr_t) (EEPROM_BASE + 2 * SLOTS + slot); }
+
+    // slot of the last save
+    static uint8_t current() {
+        uint8_t sequence = eeprom_read_byte(sequenceAt(0));
+        for (uint8_t slot = 0; slot < SLOTS - 1; slot++) {
+            uint8_t following = eeprom_read_byte(sequenceAt(slot + 1));
+            if ((uint8_t) (sequence + 1) != following)
+                return slot;
+            sequence = following;
+        }
+        return SLOTS - 1;
+    }
+};
+}  // namespace neoheart
+
+#endif  // NEOHEART_RNG_H
@@ -0,0 +1,91 @@
+#ifndef NEOHEART_SCHEDULE_H
+#define NEOHEART_SCHEDULE_H
+
+#include <Arduino.h>
+
+#include "rng.h"
+
+// Animation scheduler. Every animation of the player has an entry in a
+// registry in flash with what a run of it asks of the cell; the scheduler
+// picks the animation of each press at random, weighted, and keeps the
+// charge drawn per press within a budget over the presses.
+namespace neoheart {
+namespace schedule {
+// a run of an animation at the brightness of a fresh cell (supply.h), as
+// measured by test_energy and rounded up; test_energy fails when a run no
+// longer fits its entry. The scheduler only reads the charge and the weight:
+// the peak current and the length are budgets for test_energy alone
+struct Entry {
+    uint8_t uAh;         // charge drawn from the cell
+    uint8_t peakMa;      // highest current drawn from the cell, test_energy only
+    uint8_t durationDs;  // length, in tenths of a second, test_energy only
+    uint8_t weight;      // how often it comes up next to the others that fit
+};
+
+// average charge per press the cell is held to, 225 mAh / 32 uAh is about
+// 7000 presses
+static constexpr uint8_t BUDGET_UAH = 32;
+// charge the presses below the budget can put by for the costlier runs
+static constexpr uint8_t CREDIT_MAX = 4 * BUDGET_UAH;
+
+// A token bucket: every press adds BUDGET_UAH to the credit, up to
+// CREDIT_MAX, and the run takes its cost out of it. Over any run of presses
+// the charge drawn stays within BUDGET_UAH a press, plus CREDIT_MAX. The
+// registry needs an animation within the budget, and within every maxCost
+// the scheduler is asked for, so that a press always has one to pick.
+struct Scheduler {
+    uint8_t credit = BUDGET_UAH;
+
+    // an animation of registry within the credit and maxCost, the supply
+    // limit: those that do not fit are left out, the others keep their
+    // weights
+    template<uint8_t N>
+    uint8_t pick(const Entry (&registry)[N], uint8_t maxCost, Rng &rng) {
+        credit = credit > CREDIT_MAX - BUDGET_UAH ? CREDIT_MAX : credit + BUDGET_UAH;
+        uint8_t limit = credit < maxCost ? credit : maxCost;
+        uint8_t ticket = rng.below(totalWeight(registry, limit));
+        for (uint8_t i = 0;; i++) {
+            uint8_t cost = pgm_read_byte(&registry[i].uAh);
+            if (cost > limit)
+                continue;
+            uint8_t weight = pgm_read_byte(&registry[i].weight);
+            if (ticket < weight) {
+                credit -= cost;
+                return i;
+            }
+            ticket -= weight;
+        }
+    }
+
+    template<uint8_t N>
+    static uint8_t totalWeight(const Entry (&registry)[N], uint8_t limit) {
+        uint8_t total = 0;
+        for (uint8_t i = 0; i < N; i++)
+            if (pgm_read_byte(&registry[i].uAh) <= limit)
+                total += pgm_read_byte(&registry[i].weight);
+        return total;
+    }
+};
+
+// every press can pick a run of the registry at maxCost: one at most the
+// budget, with a weight
+template<uint8_t N>
+constexpr bool alwaysPicks(const Entry (&registry)[N], uint8_t maxCost) {
+    for (uint8_t i = 0; i < N; i++)
+        if (registry[i].uAh <= BUDGET_UAH && registry[i].uAh <= maxCost && registry[i].weight)
+            return true;
+    return false;
+}
+
+// the weights of a registry fit in the byte rng.below() draws from
+template<uint8_t N>
+constexpr bool weightsFit(const Entry (&registry)[N]) {
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < N; i++)
+        total += registry[i].weight;
+    return total > 0 && total <= 255;
+}
+}  // namespace schedule
+}  // namespace neoheart
+
+#endif  // NEOHEART_SCHEDULE_H
@@ -0,0 +1,51 @@
+#ifndef NEOHEART_SCRIPT_H
+#define NEOHEART_SCRIPT_H
+
+#include <Arduino.h>
+
+// Animation bytecode, played by the Script animation of firmware.h.
+//
+// Scripts are written as text in firmware/scripts/*.nhs and compiled by
+// tools/nhscript.py into PROGMEM arrays in src/scripts/*.h. A script is a
+// sequence of instructions, an opcode byte followed by its operands;
+// words are little endian. Levels are Q8 (0 = off, 255 = full) and apply
+// to the current color, as paintPixel() does.
+//
+//   END                               the animation is over
+//   COLOR      r g b                  current color
+//   RANDOM                            current color picked by getRandomColor()
+//   SET        pixel level            paint one pixel
+//   FILL       level                  paint the whole strip
+//   CLEAR                             turn every pixel off
+//   SHIFT      n (int8)               rotate the strip by n pixels, towards
+//                                     the higher indices when positive
+//   SHOW                              send the frame
+//   WAIT       ms (word)              resume after ms
+//   FADE       from to steps ms       steps frames: fill at from + (to -
+//                                     from) * k / steps for k = 1..steps,
+//                                     show, wait ms (byte)
+//   LOOP       count                  run the body up to the matching NEXT
+//   NEXT                              count times (1-255); loops nest up to
+//                                     SCRIPT_LOOP_DEPTH deep
+//
+// The numbering is shared with tools/nhscript.py, keep both in step.
+namespace neoheart {
+enum ScriptOp : uint8_t {
+    OP_END = 0x00,
+    OP_COLOR = 0x01,
+    OP_RANDOM = 0x02,
+    OP_SET = 0x03,
+    OP_FILL = 0x04,
+    OP_CLEAR = 0x05,
+    OP_SHIFT = 0x06,
+    OP_SHOW = 0x07,
+    OP_WAIT = 0x08,
+    OP_FADE = 0x09,
+    OP_LOOP = 0x0a,
+    OP_NEXT = 0x0b,
+};
+
+static constexpr uint8_t SCRIPT_LOOP_DEPTH = 3;
+}  // namespace neoheart
+
+#endif  // NEOHEART_SCRIPT_H
@@ -0,0 +1,15 @@
+// Generated by tools/nhscript.py from scripts/chase.nhs, do not edit.
+#ifndef NEOHEART_SCRIPT_CHASE_H
+#define NEOHEART_SCRIPT_CHASE_H
+
+#include <Arduino.h>
+
+namespace neoheart {
+static const uint8_t chaseScript[32] PROGMEM = {
+        0x02, 0x03, 0x00, 0xff, 0x03, 0x18, 0x99, 0x03, 0x17, 0x66, 0x03, 0x16,
+        0x33, 0x03, 0x15, 0x19, 0x07, 0x08, 0x28, 0x00, 0x0a, 0x4b, 0x06, 0x01,
+        0x07, 0x08, 0x28, 0x00, 0x0b, 0x05, 0x07, 0x00,
+};
+}  // namespace neoheart
+
+#endif
@@ -0,0 +1,43 @@
+#include "supply.h"
+
+#ifdef __AVR__
+namespace neoheart {
+namespace supply {
+// The 1.1 V of the reference is only good to +-4 %, more than the thresholds
+// of supply.h are apart. Each board gets its own in the first two
+// bytes of the user row, in millivolts, little endian: the result of a
+// reading at a VDD read on a meter gives it, VDD * result / (16 * 1023). An
+// erased row, or a value past the spread of the part, reads as the nominal
+// 1.1 V.
+static constexpr uint16_t NOMINAL_MV = 1100;
+static constexpr uint16_t SPREAD_MV = 1100 * 4 / 100;
+
+static uint16_t referenceMv() {
+    uint16_t mv = USERROW.USERROW0 | USERROW.USERROW1 << 8;
+    if (mv < NOMINAL_MV - SPREAD_MV || mv > NOMINAL_MV + SPREAD_MV)
+        return NOMINAL_MV;
+    return mv;
+}
+
+// untested on hardware, only the simulated supply of the native build has
+// run (supply.h)
+uint16_t readMillivolts() {
+    // the 1.1 V reference as the input, VDD as the reference: the result is
+    // 1023 * 1.1 V / VDD, summed over 16 conversions
+    VREF.CTRLA = (VREF.CTRLA & ~VREF_ADC0REFSEL_gm) | VREF_ADC0REFSEL_1V1_gc;
+    ADC0.CTRLB = ADC_SAMPNUM_ACC16_gc;
+    ADC0.CTRLC = ADC_SAMPCAP_bm | ADC_REFSEL_VDDREF_gc | ADC_PRESC_DIV16_gc;
+    // the reference settles while the ADC starts up
+    ADC0.CTRLD = ADC_INITDLY_DLY64_gc;
+    ADC0.MUXPOS = ADC_MUXPOS_INTREF_gc;
+    ADC0.CTRLA = ADC_ENABLE_bm;
+    ADC0.COMMAND = ADC_STCONV_bm;
+    while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    uint16_t result = ADC0.RES;
+    // off again, it draws current in every sleep mode it is left on in
+    ADC0.CTRLA = 0;
+    return result ? (uint32_t) referenceMv() * 16 * 1023 / result : 0;
+}
+}  // namespace supply
+}  // namespace neoheart
+#endif
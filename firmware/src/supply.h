@@ -0,0 +1,119 @@
+#ifndef NEOHEART_SUPPLY_H
+#define NEOHEART_SUPPLY_H
+
+#include <Arduino.h>
+
+#ifndef __AVR__
+#include <NeoSim.h>
+#endif
+
+// Supply monitor. The ATtiny816 runs straight off the CR2032 (+3V0 on
+// neoheart_v2.kicad_pcb), so its VDD is the battery voltage. A cell near its
+// end sags under the LED current until the core browns out: the governor
+// asks less of a weaker cell, with a dimmer strip, cheaper animations and
+// shorter runs, and none at all once it is empty.
+namespace neoheart {
+namespace supply {
+enum Level : uint8_t { SUPPLY_FRESH, SUPPLY_LOW, SUPPLY_WEAK, SUPPLY_EMPTY };
+
+// VDD at rest, read once per wake-up before the boost converter loads the
+// cell. Levels only go down, a cell reads a little higher after a rest; a
+// new one comes with a power-on reset, which starts over from SUPPLY_FRESH.
+// The curve of a CR2032 is flat, the thresholds are close: each one is the
+// rest voltage at which the peak current of the runs of the level before it
+// (test_supply) pulls the cell of the NeoSim battery model close to the
+// drop-out of the TPS61240, plus READING_ERROR_MV. That is what is left of
+// the error of a reading once the 1.1 V reference is calibrated (supply.cpp):
+// its drift over temperature and the ADC step, assumed, not yet measured
+static constexpr uint16_t READING_ERROR_MV = 30;
+static constexpr uint16_t LOW_MV = 2930 + READING_ERROR_MV;
+static constexpr uint16_t WEAK_MV = 2880 + READING_ERROR_MV;
+static constexpr uint16_t EMPTY_MV = 2860 + READING_ERROR_MV;
+// a reading that would step the level down only counts with the ones after
+// it: CONFIRM_READINGS in a row below the level enter the highest of them
+static constexpr uint8_t CONFIRM_READINGS = 3;
+// VDD under load, read every CHECK_FRAMES frames of a run: below it the run
+// stops before the TPS61240 drops out (2.3 V) and the core browns out
+static constexpr uint16_t STOP_MV = 2350;
+static constexpr uint8_t CHECK_FRAMES = 64;
+
+// what a run may ask of the cell at each level. A fresh cell gets the 5 %
+// the strip had before the current limit of NeoPixel::show(), (12 + 1) / 256:
+// the limit only clips the heavy frames, the brightness keeps the sparse and
+// dim ones from going out at full range
+struct Limits {
+    uint8_t brightness;  // NeoPixel::setBrightness()
+    uint8_t maxCost;     // uAh per run on a fresh cell, the registry of firmware.cpp
+    uint16_t maxRunMs;   // 0 for no limit
+};
+
+static constexpr Limits LIMITS[] PROGMEM = {
+        {12, 255, 0},   // SUPPLY_FRESH
+        {7, 40, 0},     // SUPPLY_LOW
+        {4, 25, 4000},  // SUPPLY_WEAK
+        {0, 0, 0},      // SUPPLY_EMPTY: no run
+};
+static constexpr uint16_t THRESHOLDS_MV[] PROGMEM = {LOW_MV, WEAK_MV, EMPTY_MV};
+
+struct Governor {
+    uint8_t level = SUPPLY_FRESH;
+    // readings in a row below the level, and the level of the highest of
+    // them. A reset, from a new cell or a brownout, starts one short of
+    // CONFIRM_READINGS:
+    // its first reading counts alone, the core may not get through the runs
+    // it would take to confirm it
+    uint8_t lowReadings = CONFIRM_READINGS - 1;
+    uint8_t pending = SUPPLY_EMPTY;
+
+    // the level for a reading at rest
+    uint8_t update(uint16_t millivolts) {
+        uint8_t reading = SUPPLY_FRESH;
+        while (reading < SUPPLY_EMPTY && millivolts < pgm_read_word(&THRESHOLDS_MV[reading]))
+            reading++;
+        if (reading <= level) {
+            lowReadings = 0;
+            return level;
+        }
+        if (!lowReadings || reading < pending)
+            pending = reading;
+        if (++lowReadings >= CONFIRM_READINGS) {
+            level = pending;
+            lowReadings = 0;
+        }
+        return level;
+    }
+
+    // a reading under load: below STOP_MV the run has to end, and the runs
+    // after it are asked less of, down to SUPPLY_WEAK. A sag says the load
+    // was too much, not that the cell is spent: only a reading at rest ends
+    // the runs
+    bool holdsUnderLoad(uint16_t millivolts) {
+        if (millivolts >= STOP_MV)
+            return true;
+        if (level < SUPPLY_WEAK)
+            level++;
+        return false;
+    }
+
+    uint8_t brightness() const { return pgm_read_byte(&LIMITS[level].brightness); }
+
+    uint8_t maxCost() const { return pgm_read_byte(&LIMITS[level].maxCost); }
+
+    uint16_t maxRunMs() const { return pgm_read_word(&LIMITS[level].maxRunMs); }
+
+    bool allowsRun() const { return level < SUPPLY_EMPTY; }
+};
+
+#ifdef __AVR__
+// VDD in millivolts, from the ADC converting the 1.1 V reference against VDD,
+// the mean of 16 conversions. The reference is the one calibrated for each
+// board in its user row (supply.cpp). Not yet run on a board
+uint16_t readMillivolts();
+#else
+// the simulated supply, a fixed voltage or a battery model (NeoSim.h)
+inline uint16_t readMillivolts() { return neosim::supplyMillivolts(); }
+#endif
+}  // namespace supply
+}  // namespace neoheart
+
+#endif  // NEOHEART_SUPPLY_H
@@ -0,0 +1,147 @@
+// Runs every animation of firmware.h on the host through NeoSim and checks
+// its frame trace against the golden file in test/golden.
+//   pio test -e native
+// After an intended change to the output, re-record the golden files with
+//   NEOSIM_UPDATE_GOLDEN=1 pio test -e native
+
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "firmware.h"
+
+using namespace neoheart;
+
+// Error bounds against the golden traces: largest difference allowed on any
+// byte sent to the strip, and on the start time of any frame
+static constexpr uint8_t PIXEL_TOLERANCE = 0;
+static constexpr uint32_t TIME_TOLERANCE_US = 0;
+
+static std::string goldenPath(const char *name) {
+    std::string dir = __FILE__;
+    dir.erase(dir.find_last_of("/\\") + 1);
+    return dir + "../golden/" + name + ".nht";
+}
+
+void setUp() {
+    neosim::reset();
+    rng = Rng();
+    // the brightness of a run on a fresh cell, whatever a previous
+    // animation left behind
+    pixels.setBrightness(supply::Governor().brightness());
+    pixels.clear();
+    // the strip is powered up with every animation, the first frame always goes out
+    pixels.begin();
+}
+
+void tearDown() {}
+
+static void checkGolden(const char *name) {
+    std::string path = goldenPath(name);
+    const char *update = getenv("NEOSIM_UPDATE_GOLDEN");
+    if (update && *update) {
+        TEST_ASSERT_TRUE_MESSAGE(neosim::writeTrace(path.c_str(), neosim::frames()), path.c_str());
+        return;
+    }
+
+    std::vector<neosim::Frame> golden;
+    TEST_ASSERT_TRUE_MESSAGE(neosim::readTrace(path.c_str(), golden), path.c_str());
+    neosim::TraceDiff diff = neosim::compareTraces(golden, neosim::frames());
+    char message[128];
+    snprintf(message, sizeof(message), "%s: first mismatch at frame %zu, pixel error %u, time error %u us",
+             name, diff.firstMismatch, diff.maxPixelError, diff.maxTimeError);
+    TEST_ASSERT_TRUE_MESSAGE(diff.sameShape, message);
+    TEST_ASSERT_TRUE_MESSAGE(diff.maxPixelError <= PIXEL_TOLERANCE, message);
+    TEST_ASSERT_TRUE_MESSAGE(diff.maxTimeError <= TIME_TOLERANCE_US, message);
+}
+
+static void checkAnimation(const char *name, void (*animation)()) {
+    animation();
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_GREATER_THAN(1, frames.size());
+    for (size_t i = 1; i < frames.size(); i++)
+        TEST_ASSERT_GREATER_THAN(frames[i - 1].time, frames[i].time);
+    // no byte goes out above the brightness cap of a fresh cell, no frame
+    // above the peak current budget
+    uint8_t cap = (255 * (supply::Governor().brightness() + 1)) >> 8;
+    for (const neosim::Frame &frame : frames) {
+        uint16_t sum = 0;
+        for (uint8_t byte : frame.bytes) {
+            TEST_ASSERT_LESS_OR_EQUAL_UINT(cap, byte);
+            sum += byte;
+        }
+        TEST_ASSERT_LESS_OR_EQUAL(NEOPIXEL_CURRENT_BUDGET, sum);
+    }
+    // every animation hands a dark strip back to the power management
+    for (uint8_t byte : frames.back().bytes)
+        TEST_ASSERT_EQUAL_UINT8(0, byte);
+    // a run is a few seconds, not minutes
+    TEST_ASSERT_LESS_THAN(60000000UL, neosim::now());
+    checkGolden(name);
+}
+
+void test_heartbeat() { checkAnimation("heartbeat", play<Heartbeat>); }
+void test_bottomup() { checkAnimation("bottomup", play<Bottomup>); }
+void test_theatherFill() { checkAnimation("theatherFill", play<TheatherFill>); }
+void test_bounce() { checkAnimation("bounce", play<Bounce>); }
+void test_incrementalFill() { checkAnimation("incrementalFill", play<IncrementalFill>); }
+void test_chase() { checkAnimation("chase", play<Chase>); }
+void test_colorWipe() { checkAnimation("colorWipe", play<ColorWipe>); }
+void test_rainbow() { checkAnimation("rainbow", play<Rainbow>); }
+void test_theaterChaseRainbow() { checkAnimation("theaterChaseRainbow", play<TheaterChaseRainbow>); }
+void test_bottomupsingle() { checkAnimation("bottomupsingle", play<Bottomupsingle>); }
+void test_firework() { checkAnimation("firework", play<Firework>); }
+
+// the Player gives the same frames as play(), and a restart drops the old state
+void test_player() {
+    Player<Chase, Heartbeat> player;
+    player.start(1, millis());
+    while (player.running()) {
+        int32_t wait = player.deadline() - millis();
+        if (wait > 0)
+            delay(wait);
+        player.tick(millis());
+    }
+    checkGolden("heartbeat");
+
+    neosim::reset();
+    rng = Rng();
+    player.start(1, millis());
+    for (uint8_t i = 0; i < 10; i++)
+        player.tick(player.deadline());
+    neosim::reset();
+    rng = Rng();
+    pixels.clear();
+    // begin() marks the frame dirty again, as in setUp(): the first frame
+    // goes out even if the strip already shows it
+    pixels.begin();
+    player.start(1, millis());
+    while (player.running())
+        player.tick(player.deadline());
+    // time stood still here, only the frames are comparable
+    std::vector<neosim::Frame> golden;
+    TEST_ASSERT_TRUE(neosim::readTrace(goldenPath("heartbeat").c_str(), golden));
+    neosim::TraceDiff diff = neosim::compareTraces(golden, neosim::frames());
+    TEST_ASSERT_TRUE(diff.sameShape);
+    TEST_ASSERT_EQUAL_UINT8(0, diff.maxPixelError);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_heartbeat);
+    RUN_TEST(test_bottomup);
+    RUN_TEST(test_theatherFill);
+    RUN_TEST(test_bounce);
+    RUN_TEST(test_incrementalFill);
+    RUN_TEST(test_chase);
+    RUN_TEST(test_colorWipe);
+    RUN_TEST(test_rainbow);
+    RUN_TEST(test_theaterChaseRainbow);
+    RUN_TEST(test_bottomupsingle);
+    RUN_TEST(test_firework);
+    RUN_TEST(test_player);
+    return UNITY_END();
+}
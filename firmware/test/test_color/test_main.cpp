@@ -0,0 +1,122 @@
+// Checks the table-driven hue path of NeoPixel (ColorHueGamma(), rainbow())
+// against ColorHSV() + gamma32(), and times both.
+//   pio test -e native -f test_color -v
+
+#include <NeoPixel.h>
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+using Strip = NeoPixel<25, PIN_PC0, NEO_GRB>;
+static Strip strip;
+
+// largest difference on any channel allowed against the 16-bit hue path,
+// from two sources. Rounding the hue to 1/256 of a turn moves a channel by
+// up to 8 where the gamma curve is steepest: ColorHSV() itself at the
+// rounded hue is that far off. At the rounded hue, red is exact, green and
+// blue are read 85 and 171 steps on instead of 85.3 and 170.7, up to 5 off.
+// After the scale of show() that is a level or two on the wire.
+static constexpr uint8_t ROUNDING_ERROR = 8;
+static constexpr uint8_t OFFSET_ERROR = 5;
+static constexpr uint8_t MAX_HUE_ERROR = ROUNDING_ERROR + OFFSET_ERROR;
+
+void setUp() { neosim::reset(); }
+
+void tearDown() {}
+
+static uint8_t channel(uint32_t color, uint8_t shift) { return color >> shift; }
+
+static uint8_t channelError(uint32_t expected, uint32_t actual) {
+    uint8_t error = 0;
+    for (uint8_t shift = 0; shift <= 16; shift += 8) {
+        uint8_t e = abs(channel(expected, shift) - channel(actual, shift));
+        if (e > error)
+            error = e;
+    }
+    return error;
+}
+
+// the 8-bit hue path against the 16-bit one, over the whole wheel, and each
+// of the two sources of its error on its own
+void test_hue_table_matches_colorhsv() {
+    uint8_t maxError = 0, roundingError = 0, offsetError = 0;
+    uint32_t total = 0;
+    for (uint32_t hue = 0; hue < 65536; hue++) {
+        uint8_t rounded = (uint16_t) (hue + 128) >> 8;
+        uint32_t expected = Strip::gamma32(Strip::ColorHSV(hue));
+        uint32_t actual = Strip::ColorHueGamma(rounded);
+        uint8_t error = channelError(expected, actual);
+        total += error;
+        if (error > maxError)
+            maxError = error;
+        error = channelError(expected, Strip::gamma32(Strip::ColorHSV(rounded << 8)));
+        if (error > roundingError)
+            roundingError = error;
+    }
+    for (uint16_t hue = 0; hue < 256; hue++) {
+        uint32_t expected = Strip::gamma32(Strip::ColorHSV(hue << 8));
+        uint32_t actual = Strip::ColorHueGamma(hue);
+        TEST_ASSERT_EQUAL_UINT8(channel(expected, 16), channel(actual, 16));
+        uint8_t error = channelError(expected, actual);
+        if (error > offsetError)
+            offsetError = error;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(ROUNDING_ERROR, roundingError);
+    TEST_ASSERT_LESS_OR_EQUAL(OFFSET_ERROR, offsetError);
+    char line[96];
+    snprintf(line, sizeof(line), "ColorHueGamma vs gamma32(ColorHSV): max error %u, mean %.2f per color", maxError,
+             total / 65536.0);
+    TEST_MESSAGE(line);
+    // the primaries fall on the 8-bit grid and come out exactly
+    TEST_ASSERT_EQUAL_HEX32(0xff0000, Strip::ColorHueGamma(0));
+    TEST_ASSERT_EQUAL_HEX32(0x00ff00, Strip::ColorHueGamma(85));
+    TEST_ASSERT_EQUAL_HEX32(0x0000ff, Strip::ColorHueGamma(171));
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_HUE_ERROR, maxError);
+}
+
+// rainbow() as it was: a 32-bit division, ColorHSV() and gamma32() per pixel
+static void rainbowHSV(Strip &s, uint16_t firstHue) {
+    for (uint16_t i = 0; i < s.numPixels(); i++) {
+        uint16_t hue = firstHue + (i * 65536L) / s.numPixels();
+        s.setPixelColor(i, Strip::gamma32(Strip::ColorHSV(hue)));
+    }
+}
+
+template<class Fill>
+static double hostNsPerPixel(Fill fill) {
+    static constexpr uint32_t FRAMES = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+        fill((uint16_t) (frame * 97));
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (FRAMES * strip.numPixels());
+}
+
+// the same strip either way, to within the hue error; host time per pixel,
+// the cycles on the ATtiny816 need the AVR toolchain
+void test_rainbow_benchmark() {
+    Strip reference;
+    for (uint32_t hue = 0; hue < 65536; hue += 251) {
+        rainbowHSV(reference, hue);
+        strip.rainbow(hue);
+        for (uint16_t i = 0; i < strip.numPixels(); i++)
+            TEST_ASSERT_LESS_OR_EQUAL(MAX_HUE_ERROR, channelError(reference.getPixelColor(i), strip.getPixelColor(i)));
+    }
+
+    double before = hostNsPerPixel([](uint16_t hue) { rainbowHSV(strip, hue); });
+    double after = hostNsPerPixel([](uint16_t hue) { strip.rainbow(hue); });
+    char line[96];
+    snprintf(line, sizeof(line), "rainbow() on the host: %.1f ns/pixel with ColorHSV, %.1f with the tables", before,
+             after);
+    TEST_MESSAGE(line);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hue_table_matches_colorhsv);
+    RUN_TEST(test_rainbow_benchmark);
+    return UNITY_END();
+}
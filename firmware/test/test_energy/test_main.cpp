@@ -0,0 +1,84 @@
+// Energy drawn from the CR2032 by one run of each animation, estimated from
+// the simulated frames with the NeoSim power model (lib/NeoSim/Energy.h).
+//   pio test -e native -f test_energy -v
+// prints the report; a run that no longer fits its entry in the registry of
+// firmware.cpp, charge, peak current or duration, fails the suite. Lower the
+// entry when an animation gets cheaper so regressions keep being caught.
+
+#include <Energy.h>
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <stdio.h>
+
+// the sketch itself, with the registry of the scheduler
+#include "firmware.cpp"
+
+using namespace neoheart;
+
+struct Budget {
+    const char *name;
+    void (*animation)();
+};
+
+// in the order of the player and the registry
+static const Budget budgets[] = {
+        {"heartbeat", play<Heartbeat>},
+        {"bottomup", play<Bottomup>},
+        {"theatherFill", play<TheatherFill>},
+        {"bounce", play<Bounce>},
+        {"incrementalFill", play<IncrementalFill>},
+        {"chase", play<Chase>},
+        {"colorWipe", play<ColorWipe>},
+        {"rainbow", play<Rainbow>},
+        {"theaterChaseRainbow", play<TheaterChaseRainbow>},
+        {"bottomupsingle", play<Bottomupsingle>},
+        {"firework", play<Firework>},
+};
+static_assert(sizeof(budgets) / sizeof(budgets[0]) == decltype(player)::count, "one per animation of the player");
+
+void setUp() {
+    neosim::reset();
+    rng = Rng();
+    // as startRandomAnim() on a fresh cell
+    pixels.setBrightness(supply::Governor().brightness());
+    pixels.clear();
+    // the strip is powered up with every animation, the first frame always goes out
+    pixels.begin();
+}
+
+void tearDown() {}
+
+void test_energy_budgets() {
+    TEST_MESSAGE("animation            uAh/run   peak mA  worst frame   duration s   awake %   skipped");
+    bool overBudget = false;
+    for (uint8_t index = 0; index < player.count; index++) {
+        const Budget &budget = budgets[index];
+        const schedule::Entry &entry = registry[index];
+        setUp();
+        uint16_t skippedBefore = pixels.skippedShows();
+        budget.animation();
+        neosim::EnergyReport report =
+                neosim::estimateEnergy(neosim::frames(), neosim::now(), NEO_GRB, neosim::sleptUs());
+        // share of the run the core is not in standby: it was 100 % when the
+        // animations waited in delay()
+        float awake = 100.0f * (neosim::now() - neosim::sleptUs()) / neosim::now();
+
+        bool over = report.mAh * 1000 > entry.uAh || report.peakMa > entry.peakMa ||
+                    report.durationUs > entry.durationDs * 100000UL;
+
+        char line[128];
+        snprintf(line, sizeof(line), "%-20s %8.1f  %8.2f  %11zu  %11.2f  %8.2f  %8u%s", budget.name,
+                 report.mAh * 1000, report.peakMa, report.worstFrame, report.durationUs / 1e6, awake,
+                 (uint16_t) (pixels.skippedShows() - skippedBefore), over ? "  OVER BUDGET" : "");
+        TEST_MESSAGE(line);
+        overBudget |= over;
+    }
+    TEST_ASSERT_FALSE(overBudget);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_energy_budgets);
+    return UNITY_END();
+}
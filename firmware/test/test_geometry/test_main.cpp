@@ -0,0 +1,69 @@
+// Checks the heart geometry of src/geometry.h beyond its static_asserts:
+// lobes, height bands and the order of the sweep tables.
+//   pio test -e native -f test_geometry
+
+#include <unity.h>
+
+#include "geometry.h"
+
+using namespace neoheart;
+
+void setUp() {}
+
+void tearDown() {}
+
+// the chain runs down the right lobe to the tip and up the left one
+void test_lobes_split_the_chain() {
+    for (uint8_t led = 0; led < LED_COUNT; led++) {
+        Lobe expected = led < TIP_LED ? LOBE_RIGHT : led > TIP_LED ? LOBE_LEFT : LOBE_CENTER;
+        TEST_ASSERT_EQUAL_UINT8(expected, lobeOf(led));
+        TEST_ASSERT_EQUAL_UINT8(LED_COUNT - 1 - led, mirrorOf(led));
+    }
+}
+
+// the tip alone is in the bottom band, the top band holds the tops of both
+// lobes and every band has LEDs in it
+void test_height_bands() {
+    uint8_t perBand[HEIGHT_BANDS] = {};
+    for (uint8_t led = 0; led < LED_COUNT; led++) {
+        TEST_ASSERT_LESS_THAN_UINT8(HEIGHT_BANDS, bandOf(led));
+        perBand[bandOf(led)]++;
+        TEST_ASSERT_EQUAL_UINT8(bandOf(led), bandOf(mirrorOf(led)));
+    }
+    for (uint8_t band = 0; band < HEIGHT_BANDS; band++)
+        TEST_ASSERT_GREATER_THAN_UINT8(0, perBand[band]);
+    TEST_ASSERT_EQUAL_UINT8(0, bandOf(TIP_LED));
+    TEST_ASSERT_EQUAL_UINT8(HEIGHT_BANDS - 1, bandOf(2));
+    TEST_ASSERT_EQUAL_UINT8(HEIGHT_BANDS - 1, bandOf(22));
+}
+
+// the height order never goes down; the outline rows climb until the tops
+// of the lobes, then come down to the notch
+void test_sweep_order() {
+    constexpr Table<uint8_t, LED_COUNT> up = heightOrder();
+    TEST_ASSERT_EQUAL_UINT8(TIP_LED, up.values[0]);
+    for (uint8_t i = 1; i < LED_COUNT; i++)
+        TEST_ASSERT_LESS_OR_EQUAL(ledPositions[up.values[i]].y, ledPositions[up.values[i - 1]].y);
+
+    constexpr Table<uint8_t, OUTLINE_ROWS> right = outlineSide<LOBE_RIGHT>();
+    constexpr Table<uint8_t, OUTLINE_ROWS> left = outlineSide<LOBE_LEFT>();
+    TEST_ASSERT_EQUAL_UINT8(TIP_LED, right.values[0]);
+    TEST_ASSERT_EQUAL_UINT8(TIP_LED, left.values[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, right.values[OUTLINE_ROWS - 1]);
+    TEST_ASSERT_EQUAL_UINT8(LED_COUNT - 1, left.values[OUTLINE_ROWS - 1]);
+    uint8_t row = 1;
+    for (; row < OUTLINE_ROWS && ledPositions[right.values[row]].y > ledPositions[right.values[row - 1]].y; row++)
+        ;
+    TEST_ASSERT_EQUAL_UINT8(LOBE_RIGHT, lobeOf(right.values[row - 1]));
+    TEST_ASSERT_EQUAL_UINT8(HEIGHT_BANDS - 1, bandOf(right.values[row - 1]));
+    for (; row < OUTLINE_ROWS; row++)
+        TEST_ASSERT_LESS_THAN(ledPositions[right.values[row - 1]].y, ledPositions[right.values[row]].y);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lobes_split_the_chain);
+    RUN_TEST(test_height_bands);
+    RUN_TEST(test_sweep_order);
+    return UNITY_END();
+}
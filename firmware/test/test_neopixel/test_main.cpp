@@ -0,0 +1,144 @@
+// Checks the NeoPixel class on the host through the NeoSim recorder.
+//   pio test -e native -f test_neopixel
+
+#include <NeoPixel.h>
+#include <NeoSim.h>
+#include <unity.h>
+
+static NeoPixel<4, PIN_PC0, NEO_GRB> strip;
+
+void setUp() {
+    neosim::reset();
+    strip.setBrightness(255);
+    strip.clear();
+    strip.begin();
+}
+
+void tearDown() {}
+
+// an unchanged framebuffer is not sent again, and every skip is counted
+void test_show_skips_unchanged_frame() {
+    uint16_t skipped = strip.skippedShows();
+    strip.setPixelColor(0, 10, 20, 30);
+    strip.show();
+    strip.show();
+    strip.show();
+    TEST_ASSERT_EQUAL(1, neosim::frames().size());
+    TEST_ASSERT_EQUAL_UINT16(skipped + 2, strip.skippedShows());
+}
+
+// writing the colors a pixel already has leaves the frame clean
+void test_rewrite_same_color_is_clean() {
+    strip.fill(strip.Color(1, 2, 3));
+    strip.show();
+    strip.fill(strip.Color(1, 2, 3));
+    strip.setPixelColor(2, 1, 2, 3);
+    strip.setPixelColor(3, strip.Color(1, 2, 3));
+    strip.show();
+    TEST_ASSERT_EQUAL(1, neosim::frames().size());
+
+    strip.setPixelColor(3, 1, 2, 4);
+    strip.show();
+    TEST_ASSERT_EQUAL(2, neosim::frames().size());
+    TEST_ASSERT_EQUAL_UINT8(4, neosim::frames().back().bytes[11]);
+}
+
+void test_clear_marks_lit_frame_only() {
+    strip.show();
+    strip.clear();
+    strip.show();
+    TEST_ASSERT_EQUAL(1, neosim::frames().size());
+
+    strip.setPixelColor(1, 255, 0, 0);
+    strip.show();
+    strip.clear();
+    strip.show();
+    TEST_ASSERT_EQUAL(3, neosim::frames().size());
+}
+
+void test_brightness_change_is_sent() {
+    strip.fill(strip.Color(200, 200, 200));
+    strip.show();
+    strip.setBrightness(100);
+    strip.show();
+    TEST_ASSERT_EQUAL(2, neosim::frames().size());
+    TEST_ASSERT_LESS_THAN_UINT8(200, neosim::frames().back().bytes[0]);
+}
+
+// NEO_UNSCALED: the brightness only exists on the wire
+void test_unscaled_brightness_keeps_colors() {
+    NeoPixel<4, PIN_PC0, NEO_GRB, 0, NEO_UNSCALED> dimmed;
+    dimmed.begin();
+    dimmed.setPixelColor(0, 201, 7, 255);
+    dimmed.setBrightness(63);
+    TEST_ASSERT_EQUAL_HEX32(0xc907ff, dimmed.getPixelColor(0));
+    dimmed.show();
+    // 64/256 of each channel, in GRB order
+    TEST_ASSERT_EQUAL_UINT8(1, neosim::frames().back().bytes[0]);
+    TEST_ASSERT_EQUAL_UINT8(50, neosim::frames().back().bytes[1]);
+    TEST_ASSERT_EQUAL_UINT8(63, neosim::frames().back().bytes[2]);
+
+    // down and back up: nothing was lost on the way
+    dimmed.setBrightness(1);
+    dimmed.show();
+    dimmed.setBrightness(255);
+    dimmed.show();
+    TEST_ASSERT_EQUAL(3, neosim::frames().size());
+    TEST_ASSERT_EQUAL_UINT8(7, neosim::frames().back().bytes[0]);
+    TEST_ASSERT_EQUAL_UINT8(201, neosim::frames().back().bytes[1]);
+    TEST_ASSERT_EQUAL_UINT8(255, neosim::frames().back().bytes[2]);
+}
+
+// brightness and the current limit are one scale: the tighter one wins
+void test_unscaled_brightness_with_current_limit() {
+    NeoPixel<4, PIN_PC0, NEO_GRB, 300, NEO_UNSCALED> limited;
+    limited.begin();
+    limited.fill(limited.Color(100, 100, 100));
+    // 1200 at full brightness, 600 at half: the limit scales to 300
+    limited.setBrightness(127);
+    limited.show();
+    uint16_t sum = 0;
+    for (uint8_t byte : neosim::frames().back().bytes)
+        sum += byte;
+    TEST_ASSERT_LESS_OR_EQUAL(300, sum);
+    TEST_ASSERT_EQUAL_UINT8(25, neosim::frames().back().bytes[0]);
+
+    // 120 at a tenth: under the limit, the brightness alone
+    limited.setBrightness(25);
+    limited.show();
+    TEST_ASSERT_EQUAL_UINT8(10, neosim::frames().back().bytes[0]);
+}
+
+// a limit far below the frame, under 1/256 of it, still holds: the scale
+// does not round down to none
+void test_current_limit_far_below_frame() {
+    NeoPixel<25, PIN_PC0, NEO_GRB, 50> limited;
+    limited.begin();
+    limited.fill(limited.Color(255, 255, 255));
+    limited.show();
+    uint16_t sum = 0;
+    for (uint8_t byte : neosim::frames().back().bytes)
+        sum += byte;
+    TEST_ASSERT_LESS_OR_EQUAL(50, sum);
+}
+
+// begin() does not know what the strip shows, the next frame goes out
+void test_begin_forces_next_frame() {
+    strip.show();
+    strip.begin();
+    strip.show();
+    TEST_ASSERT_EQUAL(2, neosim::frames().size());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_show_skips_unchanged_frame);
+    RUN_TEST(test_rewrite_same_color_is_clean);
+    RUN_TEST(test_clear_marks_lit_frame_only);
+    RUN_TEST(test_brightness_change_is_sent);
+    RUN_TEST(test_begin_forces_next_frame);
+    RUN_TEST(test_unscaled_brightness_keeps_colors);
+    RUN_TEST(test_unscaled_brightness_with_current_limit);
+    RUN_TEST(test_current_limit_far_below_frame);
+    return UNITY_END();
+}
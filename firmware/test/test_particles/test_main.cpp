@@ -0,0 +1,173 @@
+// Checks the particle pool of src/particles.h and NeoPixel::addPixel(): the
+// pool stays within its slots, particles move, age and leave the strip, and
+// the light they add is split between pixels and saturates. Times a frame of
+// a full pool on the host.
+//   pio test -e native -f test_particles -v
+
+#include <NeoPixel.h>
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+
+#include "particles.h"
+
+using namespace neoheart;
+
+using Strip = NeoPixel<25, PIN_PC0, NEO_GRB>;
+static Strip strip;
+using Pool = ParticlePool<>;
+
+static Strip::Pixel white(uint8_t) { return Strip::Pixel(255, 255, 255); }
+
+static Strip::Pixel grey(uint8_t level) { return Strip::Pixel(level, level, level); }
+
+void setUp() {
+    neosim::reset();
+    strip.setBrightness(255);
+    strip.clear();
+    strip.begin();
+}
+
+void tearDown() {}
+
+// a zeroed pool is empty and takes particles up to its capacity, within the
+// SRAM budget
+void test_spawn_up_to_capacity() {
+    static_assert(sizeof(Pool) <= PARTICLE_RAM, "the default pool fits the budget");
+    Pool pool{};
+    TEST_ASSERT_EQUAL_UINT8(0, pool.alive());
+    for (uint8_t i = 0; i < Pool::CAPACITY; i++)
+        TEST_ASSERT_EQUAL_UINT8(i, pool.spawn(i << 8, 0, 0, 10));
+    TEST_ASSERT_EQUAL_UINT8(Pool::NONE, pool.spawn(0, 0, 0, 10));
+    TEST_ASSERT_EQUAL_UINT8(Pool::CAPACITY, pool.alive());
+    pool.clear();
+    TEST_ASSERT_EQUAL_UINT8(0, pool.alive());
+}
+
+// particles move by their velocity, slowed by the drag, and are gone at the
+// end of their life or once off either end of the strip
+void test_step_moves_ages_and_kills() {
+    Pool pool{};
+    uint8_t slow = pool.spawn(3 << 8, 0x0180, 0, 3);
+    uint8_t left = pool.spawn(0x0080, -0x0100, 0, 100);
+    uint8_t right = pool.spawn(24 << 8, 0x0100, 0, 100);
+    pool.step(25, 0);
+    TEST_ASSERT_EQUAL_INT(0x0480, pool.particles[slow].position);
+    TEST_ASSERT_EQUAL_UINT8(2, pool.particles[slow].life);
+    TEST_ASSERT_EQUAL_UINT8(0, pool.particles[left].life);
+    TEST_ASSERT_EQUAL_UINT8(0, pool.particles[right].life);
+    pool.step(25, 4);
+    TEST_ASSERT_EQUAL_INT(0x0600, pool.particles[slow].position);
+    TEST_ASSERT_EQUAL_INT(0x0180 - (0x0180 >> 4), pool.particles[slow].velocity);
+    pool.step(25, 4);
+    TEST_ASSERT_EQUAL_UINT8(0, pool.alive());
+    // a freed slot is taken again
+    TEST_ASSERT_EQUAL_UINT8(0, pool.spawn(0, 0, 0, 1));
+}
+
+// drag slows particles down the same either way, the slowest too: a burst
+// spreads evenly about where it started
+void test_drag_is_symmetric() {
+    for (int16_t speed = 1; speed < 0x0080; speed++) {
+        Pool pool{};
+        uint8_t right = pool.spawn(12 << 8, speed, 0, 200);
+        uint8_t left = pool.spawn(12 << 8, -speed, 0, 200);
+        for (uint8_t frame = 0; frame < 100; frame++) {
+            pool.step(25, 4);
+            TEST_ASSERT_EQUAL_INT(pool.particles[right].velocity, -pool.particles[left].velocity);
+            TEST_ASSERT_EQUAL_INT(pool.particles[right].position - (12 << 8),
+                                  (12 << 8) - pool.particles[left].position);
+        }
+    }
+}
+
+// a particle between two pixels lights both, in the share of its position,
+// and the two add up to its full level
+void test_render_splits_between_pixels() {
+    Pool pool{};
+    pool.spawn(0x0340, 0, 0, 100);
+    pool.render(strip, white);
+    TEST_ASSERT_EQUAL_HEX32(0xBFBFBF, strip.getPixelColor(3));
+    TEST_ASSERT_EQUAL_HEX32(0x404040, strip.getPixelColor(4));
+    TEST_ASSERT_EQUAL_HEX32(0, strip.getPixelColor(5));
+
+    for (uint16_t fraction = 0; fraction < 256; fraction++) {
+        strip.clear();
+        pool.clear();
+        pool.spawn(0x0a00 + fraction, 0, 0, 100);
+        pool.render(strip, white);
+        uint16_t sum = (strip.getPixelColor(10) & 0xff) + (strip.getPixelColor(11) & 0xff);
+        TEST_ASSERT_INT_WITHIN(1, 255, sum);
+    }
+
+    // the last pixel has no next one to spill onto
+    strip.clear();
+    pool.clear();
+    pool.spawn(0x1880, 0, 0, 100);
+    pool.render(strip, white);
+    TEST_ASSERT_EQUAL_HEX32(0x7F7F7F, strip.getPixelColor(24));
+}
+
+// overlapping particles add up and clip at 255 rather than wrapping, and a
+// particle fades out over its last frames
+void test_render_saturates_and_fades() {
+    Pool pool{};
+    pool.spawn(0x0500, 0, 200, 100);
+    pool.spawn(0x0500, 0, 100, 100);
+    pool.render(strip, grey);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFF, strip.getPixelColor(5));
+
+    strip.clear();
+    strip.addPixel(6, Strip::Pixel(200, 10, 0));
+    strip.addPixel(6, Strip::Pixel(100, 10, 0), 127);
+    TEST_ASSERT_EQUAL_HEX32(0xFA0F00, strip.getPixelColor(6));
+    strip.addPixel(25, Strip::Pixel(255, 255, 255));
+    TEST_ASSERT_EQUAL_HEX32(0, strip.getPixelColor(24));
+
+    uint8_t last = 0xff;
+    for (uint8_t life = 16; life > 0; life--) {
+        strip.clear();
+        pool.clear();
+        pool.spawn(0x0700, 0, 0, life);
+        pool.render(strip, white);
+        uint8_t level = strip.getPixelColor(7);
+        TEST_ASSERT_LESS_OR_EQUAL(last, level);
+        last = level;
+    }
+    TEST_ASSERT_EQUAL_UINT8(16, last);
+}
+
+// host time of a frame of a full pool, per particle: moving, aging and
+// drawing it; the cycles on the ATtiny816 need the AVR toolchain
+void test_particle_benchmark() {
+    static constexpr uint32_t FRAMES = 200000;
+    Pool pool{};
+    uint32_t particles = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        while (pool.spawn((frame % 25) << 8, (int16_t) (frame % 97) - 48, frame % 3, 40) != Pool::NONE) {}
+        particles += pool.alive();
+        strip.clear();
+        pool.step(25, 4);
+        pool.render(strip, grey);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    char line[96];
+    snprintf(line, sizeof(line), "particles: %.2f ns/particle/frame, pool of %u in %zu bytes",
+             elapsed.count() / particles, Pool::CAPACITY, sizeof(Pool));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_UINT32(FRAMES * Pool::CAPACITY, particles);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_spawn_up_to_capacity);
+    RUN_TEST(test_step_moves_ages_and_kills);
+    RUN_TEST(test_drag_is_symmetric);
+    RUN_TEST(test_render_splits_between_pixels);
+    RUN_TEST(test_render_saturates_and_fades);
+    RUN_TEST(test_particle_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,111 @@
+// Checks the LFSR permutations of src/permutation.h: every order visits each
+// index once, whatever the count, the taps, the start and the mask, and the
+// orders do not halve from one index to the next as the bare LFSR does.
+//   pio test -e native -f test_permutation
+
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "permutation.h"
+
+using namespace neoheart;
+
+void setUp() {}
+
+void tearDown() {}
+
+// every order of Count, from every start with every taps, under every mask
+// or, for the wide ones, a spread of them
+template<uint8_t Count>
+static void checkAllOrders() {
+    using Order = Permutation<Count>;
+    // the width is the smallest one: fewer states skipped than visited
+    TEST_ASSERT_GREATER_OR_EQUAL(Count, Order::PERIOD);
+    if (Count > 1)
+        TEST_ASSERT_LESS_OR_EQUAL(2 * Count, Order::PERIOD + 1);
+    uint8_t maskStep = Order::PERIOD > 63 ? 37 : 1;
+    for (uint8_t t = 0; t < Order::TAPS.size; t++) {
+        for (uint16_t start = 1; start <= Order::PERIOD; start++) {
+            for (uint16_t mask = 1; mask <= Order::PERIOD; mask += maskStep) {
+                Order order{(uint8_t) start, Order::TAPS.values[t], (uint8_t) mask};
+                bool seen[Count] = {};
+                for (uint8_t i = 0; i < Count; i++) {
+                    uint8_t index = order.next();
+                    TEST_ASSERT_LESS_THAN(Count, index);
+                    TEST_ASSERT_FALSE(seen[index]);
+                    seen[index] = true;
+                }
+            }
+        }
+    }
+}
+
+void test_each_index_once() {
+    checkAllOrders<1>();
+    checkAllOrders<2>();
+    checkAllOrders<7>();
+    checkAllOrders<8>();
+    checkAllOrders<25>();
+    checkAllOrders<31>();
+    checkAllOrders<100>();
+    checkAllOrders<255>();
+}
+
+// the number of maximal taps of each width, from the count of primitive
+// polynomials over GF(2)
+void test_maximal_taps() {
+    TEST_ASSERT_EQUAL_UINT8(1, maximalTapCount<2>());
+    TEST_ASSERT_EQUAL_UINT8(2, maximalTapCount<3>());
+    TEST_ASSERT_EQUAL_UINT8(2, maximalTapCount<4>());
+    TEST_ASSERT_EQUAL_UINT8(6, maximalTapCount<5>());
+    TEST_ASSERT_EQUAL_UINT8(6, maximalTapCount<6>());
+    TEST_ASSERT_EQUAL_UINT8(18, maximalTapCount<7>());
+    TEST_ASSERT_EQUAL_UINT8(16, maximalTapCount<8>());
+}
+
+// the state of an order is three bytes, and begin() spreads the orders over
+// many different first pixels
+void test_random_orders() {
+    TEST_ASSERT_EQUAL(3, sizeof(Permutation<25>));
+    Rng rng;
+    uint8_t firsts[25] = {};
+    for (uint16_t run = 0; run < 2500; run++) {
+        Permutation<25> order;
+        order.begin(rng);
+        firsts[order.next()]++;
+    }
+    for (uint8_t index = 0; index < 25; index++)
+        TEST_ASSERT_GREATER_THAN_UINT8(50, firsts[index]);
+}
+
+// the bare LFSR follows an even state with its half, pixel 19 with 9 then 4;
+// the mask leaves a step to the half of the last pixel as rare as chance
+void test_no_halving_runs() {
+    Rng rng;
+    uint16_t halvings = 0, steps = 0;
+    for (uint16_t run = 0; run < 1000; run++) {
+        Permutation<25> order;
+        order.begin(rng);
+        uint8_t last = order.next();
+        for (uint8_t i = 1; i < 25; i++) {
+            uint8_t index = order.next();
+            halvings += index + 1 == (last + 1) / 2;
+            steps++;
+            last = index;
+        }
+    }
+    char line[64];
+    snprintf(line, sizeof(line), "halving steps: %.1f %%", 100.0 * halvings / steps);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN(steps / 10, halvings);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_each_index_once);
+    RUN_TEST(test_maximal_taps);
+    RUN_TEST(test_random_orders);
+    RUN_TEST(test_no_halving_runs);
+    return UNITY_END();
+}
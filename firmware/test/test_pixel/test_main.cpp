@@ -0,0 +1,230 @@
+// Checks the wire-order pixel API of NeoPixel (Pixel, setPixel(),
+// fillPixels(), copyPixels(), shiftPixels()) against the packed 32-bit one,
+// and the bulk kernels (rotatePixels(), scalePixels()) against plain loops,
+// and times both.
+//   pio test -e native -f test_pixel -v
+
+#include <NeoPixel.h>
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+using Strip = NeoPixel<25, PIN_PC0, NEO_GRB>;
+static Strip strip;
+
+void setUp() {
+    neosim::reset();
+    strip.setBrightness(255);
+    strip.clear();
+    strip.begin();
+}
+
+void tearDown() {}
+
+static void assertSameFrame(Strip &expected, Strip &actual) {
+    expected.show();
+    actual.show();
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frames[frames.size() - 2].bytes.data(), frames.back().bytes.data(),
+                                  3 * strip.numPixels());
+}
+
+// the bytes go out in GRB order, as setPixelColor() would store them
+void test_pixel_is_in_wire_order() {
+    constexpr Strip::Pixel pixel(10, 20, 30);
+    static_assert(pixel.wire[0] == 20 && pixel.wire[1] == 10 && pixel.wire[2] == 30, "NEO_GRB");
+    TEST_ASSERT_EQUAL_UINT8(10, pixel.red());
+    TEST_ASSERT_EQUAL_UINT8(20, pixel.green());
+    TEST_ASSERT_EQUAL_UINT8(30, pixel.blue());
+
+    // at a stored brightness too, and only once
+    Strip packed;
+    packed.begin();
+    packed.setBrightness(40);
+    strip.setBrightness(40);
+    for (uint16_t i = 0; i < strip.numPixels(); i++) {
+        packed.setPixelColor(i, Strip::Color(i * 10, 255 - i, i));
+        strip.setPixel(i, Strip::Pixel(i * 10, 255 - i, i));
+    }
+    assertSameFrame(packed, strip);
+    packed.fill(Strip::Color(200, 100, 50), 3, 7);
+    strip.fillPixels(Strip::Pixel(200, 100, 50), 3, 7);
+    assertSameFrame(packed, strip);
+    TEST_ASSERT_EQUAL_HEX32(packed.getPixelColor(4), strip.getPixelColor(4));
+}
+
+// fillPixels() clips like fill(), out of range pixels are left alone
+void test_fill_clips_range() {
+    Strip packed;
+    packed.begin();
+    packed.fill(Strip::Color(1, 2, 3), 20, 10);
+    packed.fill(Strip::Color(4, 5, 6), 25);
+    packed.setPixelColor(25, Strip::Color(7, 8, 9));
+    strip.fillPixels(Strip::Pixel(1, 2, 3), 20, 10);
+    strip.fillPixels(Strip::Pixel(4, 5, 6), 25);
+    strip.setPixel(25, Strip::Pixel(7, 8, 9));
+    assertSameFrame(packed, strip);
+    TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(19).red());
+    TEST_ASSERT_EQUAL_UINT8(1, strip.getPixel(24).red());
+    TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(25).red());
+}
+
+// overlapping copies either way, and shifts that blank what they leave
+void test_copy_and_shift_ranges() {
+    for (uint16_t i = 0; i < strip.numPixels(); i++)
+        strip.setPixel(i, Strip::Pixel(i, 0, 0));
+    strip.copyPixels(2, 0, 5);
+    for (uint16_t i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_UINT8(i, strip.getPixel(i + 2).red());
+    strip.copyPixels(0, 2, 5);
+    for (uint16_t i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_UINT8(i, strip.getPixel(i).red());
+    // clipped to the end of the strip
+    strip.copyPixels(23, 0, 10);
+    TEST_ASSERT_EQUAL_UINT8(1, strip.getPixel(24).red());
+
+    for (uint16_t i = 0; i < strip.numPixels(); i++)
+        strip.setPixel(i, Strip::Pixel(i + 1, 0, 0));
+    strip.shiftPixels(3, 10, 10);
+    TEST_ASSERT_EQUAL_UINT8(10, strip.getPixel(9).red());
+    for (uint16_t i = 10; i < 13; i++)
+        TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(i).red());
+    TEST_ASSERT_EQUAL_UINT8(11, strip.getPixel(13).red());
+    TEST_ASSERT_EQUAL_UINT8(17, strip.getPixel(19).red());
+    TEST_ASSERT_EQUAL_UINT8(21, strip.getPixel(20).red());
+    strip.shiftPixels(-5);
+    TEST_ASSERT_EQUAL_UINT8(10, strip.getPixel(4).red());
+    TEST_ASSERT_EQUAL_UINT8(25, strip.getPixel(19).red());
+    TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(20).red());
+    strip.shiftPixels(30);
+    for (uint16_t i = 0; i < strip.numPixels(); i++)
+        TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(i).red());
+
+    // a shift that moves nothing leaves the frame clean
+    strip.show();
+    strip.shiftPixels(1);
+    strip.show();
+    TEST_ASSERT_EQUAL_UINT16(1, strip.skippedShows());
+}
+
+// every rotation of every range, either way, against a copy through a
+// plain array
+void test_rotate_matches_reference() {
+    for (uint16_t first = 0; first < 4; first++) {
+        for (uint16_t count = 1; first + count <= strip.numPixels(); count++) {
+            for (int16_t by = -30; by <= 30; by++) {
+                for (uint16_t i = 0; i < strip.numPixels(); i++)
+                    strip.setPixel(i, Strip::Pixel(i, i + 100, 255 - i));
+                strip.rotatePixels(by, first, count);
+                for (uint16_t i = 0; i < strip.numPixels(); i++) {
+                    uint16_t from = i;
+                    if (i >= first && i < first + count)
+                        from = first + ((i - first - by) % count + 2 * count) % count;
+                    TEST_ASSERT_EQUAL_UINT8(from, strip.getPixel(i).red());
+                    TEST_ASSERT_EQUAL_UINT8(255 - from, strip.getPixel(i).blue());
+                }
+            }
+        }
+    }
+}
+
+// scalePixels() is scaleChannel() of firmware.h on every byte of the range
+void test_scale_range() {
+    strip.fillPixels(Strip::Pixel(255, 128, 1));
+    strip.scalePixels(127, 5, 10);
+    TEST_ASSERT_EQUAL_UINT8(255, strip.getPixel(4).red());
+    TEST_ASSERT_EQUAL_UINT8(127, strip.getPixel(5).red());
+    TEST_ASSERT_EQUAL_UINT8(64, strip.getPixel(5).green());
+    TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(14).blue());
+    TEST_ASSERT_EQUAL_UINT8(255, strip.getPixel(15).red());
+
+    // full scale changes nothing, the frame stays clean
+    strip.show();
+    uint16_t skipped = strip.skippedShows();
+    strip.scalePixels(255);
+    strip.show();
+    TEST_ASSERT_EQUAL_UINT16(skipped + 1, strip.skippedShows());
+    strip.scalePixels(0);
+    for (uint16_t i = 0; i < strip.numPixels(); i++)
+        TEST_ASSERT_EQUAL_UINT8(0, strip.getPixel(i).red());
+}
+
+template<class Paint>
+static double hostNsPerPixel(Paint paint) {
+    static constexpr uint32_t FRAMES = 200000;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+        paint((uint8_t) frame);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (FRAMES * strip.numPixels());
+}
+
+static uint8_t scaleChannel(uint8_t c, uint8_t level) { return (c * (uint16_t) (level + 1)) >> 8; }
+
+// host time per pixel of the two paths, for fill() and for the inner loop
+// of the animations (firmware.h paintPixel(): a color scaled to a level,
+// then stored); the cycles on the ATtiny816 need the AVR toolchain
+void test_pixel_benchmark() {
+    static constexpr uint8_t R = 255, G = 25, B = 221;
+    char line[96];
+
+    // fill() as it was: setPixelColor() on every pixel of the range
+    double before = hostNsPerPixel([](uint8_t level) {
+        for (uint16_t i = 0; i < strip.numPixels(); i++)
+            strip.setPixelColor(i, Strip::Color(level, level, level));
+    });
+    double after = hostNsPerPixel([](uint8_t level) { strip.fillPixels(Strip::Pixel(level, level, level)); });
+    snprintf(line, sizeof(line), "fill: %.2f ns/pixel packed, %.2f ns/pixel in wire order", before, after);
+    TEST_MESSAGE(line);
+
+    before = hostNsPerPixel([](uint8_t level) {
+        for (uint16_t i = 0; i < strip.numPixels(); i++)
+            strip.setPixelColor(i, Strip::Color(scaleChannel(R, level + i), scaleChannel(G, level + i),
+                                                scaleChannel(B, level + i)));
+    });
+    after = hostNsPerPixel([](uint8_t level) {
+        for (uint16_t i = 0; i < strip.numPixels(); i++)
+            strip.setPixel(i, Strip::Pixel(scaleChannel(R, level + i), scaleChannel(G, level + i),
+                                           scaleChannel(B, level + i)));
+    });
+    snprintf(line, sizeof(line), "paintPixel: %.2f ns/pixel packed, %.2f ns/pixel in wire order", before, after);
+    TEST_MESSAGE(line);
+}
+
+// the script interpreter rotated one pixel at a time through
+// getPixelColor()/setPixelColor(); fades repainted the strip from the color
+void test_kernel_benchmark() {
+    char line[96];
+    for (uint16_t i = 0; i < strip.numPixels(); i++)
+        strip.setPixel(i, Strip::Pixel(i, 2 * i, 3 * i));
+
+    double before = hostNsPerPixel([](uint8_t) {
+        uint32_t last = strip.getPixelColor(strip.numPixels() - 1);
+        for (uint16_t i = strip.numPixels() - 1; i > 0; i--)
+            strip.setPixelColor(i, strip.getPixelColor(i - 1));
+        strip.setPixelColor(0, last);
+    });
+    double after = hostNsPerPixel([](uint8_t) { strip.rotatePixels(1); });
+    snprintf(line, sizeof(line), "rotate by 1: %.2f ns/pixel packed, %.2f ns/pixel in place", before, after);
+    TEST_MESSAGE(line);
+
+    before = hostNsPerPixel([](uint8_t level) { strip.fill(Strip::Color(level, level / 2, level / 3)); });
+    after = hostNsPerPixel([](uint8_t level) { strip.scalePixels(level | 0x80); });
+    snprintf(line, sizeof(line), "fade: %.2f ns/pixel repainted, %.2f ns/pixel scaled", before, after);
+    TEST_MESSAGE(line);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pixel_is_in_wire_order);
+    RUN_TEST(test_fill_clips_range);
+    RUN_TEST(test_copy_and_shift_ranges);
+    RUN_TEST(test_rotate_matches_reference);
+    RUN_TEST(test_scale_range);
+    RUN_TEST(test_pixel_benchmark);
+    RUN_TEST(test_kernel_benchmark);
+    return UNITY_END();
+}
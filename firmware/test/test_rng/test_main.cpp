@@ -0,0 +1,98 @@
+// Checks the xorshift generator of src/rng.h and its EEPROM wear levelling,
+// on the EEPROM of NeoSim.
+//   pio test -e native -f test_rng
+
+#include <NeoSim.h>
+#include <unity.h>
+
+#include "rng.h"
+
+using namespace neoheart;
+
+void setUp() {
+    neosim::reset();
+    neosim::eraseEeprom();
+}
+
+void tearDown() {}
+
+// every non-zero state comes up once before the sequence repeats
+void test_full_period() {
+    Rng rng;
+    uint32_t period = 0;
+    do {
+        rng.next();
+        period++;
+        TEST_ASSERT_NOT_EQUAL(0, rng.state);
+    } while (rng.state != 1 && period <= 65536);
+    TEST_ASSERT_EQUAL_UINT32(65535, period);
+}
+
+// below(n) covers 0 to n - 1 evenly enough for picking colors and pixels
+void test_below_is_in_range_and_spread() {
+    Rng rng;
+    uint32_t counts[25] = {};
+    for (uint32_t i = 0; i < 65535; i++) {
+        uint8_t value = rng.below(25);
+        TEST_ASSERT_LESS_THAN_UINT8(25, value);
+        counts[value]++;
+    }
+    // 65535 / 25 = 2621.4
+    for (uint8_t value = 0; value < 25; value++) {
+        TEST_ASSERT_GREATER_OR_EQUAL(2621, counts[value]);
+        TEST_ASSERT_LESS_OR_EQUAL(2622, counts[value]);
+    }
+}
+
+// the sequence goes on across a power loss, from a blank EEPROM too
+void test_state_survives_power_loss() {
+    Rng rng;
+    rng.load();
+    TEST_ASSERT_EQUAL_HEX16(0xffff, rng.state);
+    for (uint8_t save = 0; save < 40; save++) {
+        rng.next();
+        rng.save();
+        Rng restored;
+        restored.load();
+        TEST_ASSERT_EQUAL_HEX16(rng.state, restored.state);
+    }
+}
+
+// saves go round the slots, so every byte wears at 1/SLOTS of the save rate
+void test_saves_are_spread_over_slots() {
+    Rng rng;
+    static constexpr uint16_t SAVES = 50 * Rng::SLOTS;
+    for (uint16_t save = 0; save < SAVES; save++) {
+        rng.next();
+        rng.save();
+    }
+    for (uint16_t address = 0; address < 3 * Rng::SLOTS; address++)
+        TEST_ASSERT_LESS_OR_EQUAL(SAVES / Rng::SLOTS, neosim::eepromWrites(address));
+    for (uint16_t address = 3 * Rng::SLOTS; address < neosim::EEPROM_SIZE; address++)
+        TEST_ASSERT_EQUAL_UINT32(0, neosim::eepromWrites(address));
+}
+
+// a save cut short before its sequence byte leaves the previous state current
+void test_torn_save_keeps_previous_state() {
+    Rng rng;
+    for (uint8_t save = 0; save < 5; save++) {
+        rng.next();
+        rng.save();
+    }
+    uint16_t saved = rng.state;
+    // the next slot gets its new state, the power goes before the sequence byte
+    eeprom_update_word((uint16_t *) (uintptr_t) (2 * 6), rng.next());
+    Rng restored;
+    restored.load();
+    TEST_ASSERT_EQUAL_HEX16(saved, restored.state);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_period);
+    RUN_TEST(test_below_is_in_range_and_spread);
+    RUN_TEST(test_state_survives_power_loss);
+    RUN_TEST(test_saves_are_spread_over_slots);
+    RUN_TEST(test_torn_save_keeps_previous_state);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+// Scheduler of src/schedule.h over the registry of firmware.cpp: the charge
+// drawn per press and how often each animation comes up, over thousands of
+// presses.
+//   pio test -e native -f test_schedule -v
+// prints the distribution.
+
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <stdio.h>
+
+// the sketch itself, with the registry of the scheduler
+#include "firmware.cpp"
+
+static constexpr uint16_t PRESSES = 20000;
+// presses of the rolling window the budget is checked over
+static constexpr uint8_t WINDOW = 32;
+
+static const char *const names[] = {
+        "heartbeat", "bottomup",  "theatherFill", "bounce",              "incrementalFill",
+        "chase",     "colorWipe", "rainbow",      "theaterChaseRainbow", "bottomupsingle",
+        "firework",
+};
+static_assert(sizeof(names) / sizeof(names[0]) == decltype(player)::count, "one per animation of the player");
+
+void setUp() { rng = Rng(); }
+
+void tearDown() {}
+
+// the charge of the last WINDOW presses never goes over their budget by more
+// than the credit put by before them
+void test_rolling_average_within_budget() {
+    schedule::Scheduler scheduler;
+    uint8_t costs[WINDOW] = {};
+    uint16_t windowUAh = 0, worstUAh = 0;
+    uint32_t totalUAh = 0;
+    for (uint16_t press = 0; press < PRESSES; press++) {
+        uint8_t cost = registry[scheduler.pick(registry, 255, rng)].uAh;
+        windowUAh += cost - costs[press % WINDOW];
+        costs[press % WINDOW] = cost;
+        totalUAh += cost;
+        if (windowUAh > worstUAh)
+            worstUAh = windowUAh;
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "average %.2f uAh/press, worst %u presses %u uAh, budget %u uAh/press",
+             (float) totalUAh / PRESSES, WINDOW, worstUAh, schedule::BUDGET_UAH);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_OR_EQUAL(WINDOW * schedule::BUDGET_UAH + schedule::CREDIT_MAX, worstUAh);
+    TEST_ASSERT_LESS_OR_EQUAL(schedule::BUDGET_UAH * PRESSES + schedule::CREDIT_MAX, totalUAh);
+}
+
+// every animation comes up; those within the budget of a press as often as
+// their weights say, the costlier ones less
+void test_distribution() {
+    schedule::Scheduler scheduler;
+    uint16_t picks[player.count] = {};
+    for (uint16_t press = 0; press < PRESSES; press++)
+        picks[scheduler.pick(registry, 255, rng)]++;
+
+    uint16_t totalWeight = 0;
+    for (uint8_t index = 0; index < player.count; index++)
+        totalWeight += registry[index].weight;
+    TEST_MESSAGE("animation            uAh  weight %  picked %");
+    for (uint8_t index = 0; index < player.count; index++) {
+        char line[96];
+        snprintf(line, sizeof(line), "%-20s %3u  %8.1f  %8.1f", names[index], registry[index].uAh,
+                 100.0f * registry[index].weight / totalWeight, 100.0f * picks[index] / PRESSES);
+        TEST_MESSAGE(line);
+    }
+
+    // picks per unit of weight of the animations within the budget of a press
+    float perWeight = 0;
+    uint16_t cheapWeight = 0;
+    for (uint8_t index = 0; index < player.count; index++)
+        if (registry[index].uAh <= schedule::BUDGET_UAH) {
+            perWeight += picks[index];
+            cheapWeight += registry[index].weight;
+        }
+    perWeight /= cheapWeight;
+    for (uint8_t index = 0; index < player.count; index++) {
+        float share = picks[index] / (perWeight * registry[index].weight);
+        TEST_ASSERT_GREATER_THAN(PRESSES / 200, picks[index]);
+        if (registry[index].uAh <= schedule::BUDGET_UAH) {
+            TEST_ASSERT_FLOAT_WITHIN(0.1f, 1.0f, share);
+        } else {
+            TEST_ASSERT_TRUE(share < 1.1f);
+        }
+    }
+}
+
+// a supply limit leaves out what it does not allow, whatever the credit
+void test_supply_limit() {
+    schedule::Scheduler scheduler;
+    scheduler.credit = schedule::CREDIT_MAX;
+    for (uint16_t press = 0; press < 1000; press++) {
+        uint8_t maxCost = supply::LIMITS[supply::SUPPLY_WEAK].maxCost;
+        TEST_ASSERT_LESS_OR_EQUAL(maxCost, registry[scheduler.pick(registry, maxCost, rng)].uAh);
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rolling_average_within_budget);
+    RUN_TEST(test_distribution);
+    RUN_TEST(test_supply_limit);
+    return UNITY_END();
+}
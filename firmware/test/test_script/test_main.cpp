@@ -0,0 +1,162 @@
+// Runs hand-assembled scripts through the Script animation of firmware.h,
+// and times the interpreter against the same effect written in C++.
+//   pio test -e native -f test_script -v
+
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+
+#include "firmware.h"
+
+using namespace neoheart;
+
+namespace neoheart {
+static const uint8_t fadeProgram[] PROGMEM = {
+        OP_COLOR, 16, 0, 0,
+        OP_FADE, 0, 255, 4, 20,
+        OP_END};
+
+static const uint8_t loopProgram[] PROGMEM = {
+        OP_COLOR, 0, 8, 0,
+        OP_LOOP, 3,
+        OP_LOOP, 2,
+        OP_SET, 0, 255, OP_SHOW, OP_WAIT, 1, 0,
+        OP_CLEAR, OP_SHOW, OP_WAIT, 1, 0,
+        OP_NEXT,
+        OP_WAIT, 0x2c, 0x01,  // 300 ms
+        OP_NEXT,
+        OP_END};
+
+static const uint8_t shiftProgram[] PROGMEM = {
+        OP_COLOR, 0, 0, 8,
+        OP_SET, 0, 255, OP_SET, 1, 128,
+        OP_SHIFT, 0xfe,  // -2
+        OP_SHOW,
+        OP_SHIFT, 3,
+        OP_SHOW,
+        OP_END};
+}  // namespace neoheart
+
+// The chase animation as it was written in C++, before it became
+// scripts/chase.nhs: the reference for the interpreter benchmark
+struct NativeChase : Coroutine {
+    uint8_t i;
+
+    uint32_t step(uint32_t now) {
+        ANIM_BEGIN();
+        getRandomColor();
+        for (i = 0; i < (NEOPIXEL_COUNT * 3) + 1; i++) {
+            {
+                int currentPixel = i % NEOPIXEL_COUNT;
+                int p = currentPixel - 5 >= 0 ? currentPixel - 5 : (currentPixel - 5) + NEOPIXEL_COUNT;
+                turnOffPixel(p);
+                p = currentPixel - 4 >= 0 ? currentPixel - 4 : (currentPixel - 4) + NEOPIXEL_COUNT;
+                paintPixel(p, fraction(1, 10));
+                p = currentPixel - 3 >= 0 ? currentPixel - 3 : (currentPixel - 3) + NEOPIXEL_COUNT;
+                paintPixel(p, fraction(1, 5));
+                p = currentPixel - 2 >= 0 ? currentPixel - 2 : (currentPixel - 2) + NEOPIXEL_COUNT;
+                paintPixel(p, fraction(2, 5));
+                p = currentPixel - 1 >= 0 ? currentPixel - 1 : (currentPixel - 1) + NEOPIXEL_COUNT;
+                paintPixel(p, fraction(3, 5));
+                paintPixel(currentPixel, LEVEL_FULL);
+                pixels.show();
+            }
+            ANIM_WAIT(40);
+        }
+        clearStrip();
+        ANIM_END();
+    }
+};
+
+void setUp() {
+    neosim::reset();
+    rng = Rng();
+    pixels.setBrightness(255);
+    pixels.clear();
+    pixels.begin();
+}
+
+void tearDown() {}
+
+// red byte of a pixel in a GRB frame
+static uint8_t red(const neosim::Frame &frame, uint8_t pixel) { return frame.bytes[pixel * 3 + 1]; }
+
+void test_fade() {
+    play<Script<fadeProgram>>();
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_EQUAL(4, frames.size());
+    // levels 63, 127, 191, 255 of a red of 16
+    const uint8_t expected[] = {4, 8, 12, 16};
+    for (uint8_t k = 0; k < 4; k++)
+        TEST_ASSERT_EQUAL_UINT8(expected[k], red(frames[k], 24));
+    for (uint8_t k = 1; k < 4; k++)
+        TEST_ASSERT_GREATER_OR_EQUAL(20000, frames[k].time - frames[k - 1].time);
+}
+
+void test_nested_loops_and_waits() {
+    play<Script<loopProgram>>();
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_EQUAL(3 * 2 * 2, frames.size());
+    // the inner loop is over after 4 frames, then the 300 ms wait
+    TEST_ASSERT_GREATER_OR_EQUAL(300000, frames[4].time - frames[3].time);
+    TEST_ASSERT_LESS_THAN(10000, frames[3].time - frames[2].time);
+}
+
+void test_shift_wraps_both_ways() {
+    play<Script<shiftProgram>>();
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_EQUAL(2, frames.size());
+    // pixels 0 and 1 went to 23 and 24, then on to 1 and 2
+    TEST_ASSERT_EQUAL_UINT8(8, frames[0].bytes[23 * 3 + 2]);
+    TEST_ASSERT_EQUAL_UINT8(4, frames[0].bytes[24 * 3 + 2]);
+    TEST_ASSERT_EQUAL_UINT8(8, frames[1].bytes[1 * 3 + 2]);
+    TEST_ASSERT_EQUAL_UINT8(4, frames[1].bytes[2 * 3 + 2]);
+    TEST_ASSERT_EQUAL_UINT8(0, frames[1].bytes[23 * 3 + 2]);
+}
+
+// host time per animation frame, frame recording included; the cycles on
+// the ATtiny816 itself need the AVR toolchain
+template<class Animation>
+static double hostUsPerFrame(size_t &frames) {
+    static constexpr int RUNS = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < RUNS; run++) {
+        setUp();
+        play<Animation>();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    frames = neosim::frames().size();
+    return elapsed.count() / (RUNS * frames);
+}
+
+void test_chase_script_matches_native() {
+    play<NativeChase>();
+    std::vector<neosim::Frame> native = neosim::frames();
+    setUp();
+    play<Chase>();
+    neosim::TraceDiff diff = neosim::compareTraces(native, neosim::frames());
+    TEST_ASSERT_TRUE(diff.sameShape);
+    TEST_ASSERT_EQUAL_UINT8(0, diff.maxPixelError);
+    TEST_ASSERT_EQUAL_UINT32(0, diff.maxTimeError);
+
+    size_t nativeFrames, scriptFrames;
+    double nativeUs = hostUsPerFrame<NativeChase>(nativeFrames);
+    double scriptUs = hostUsPerFrame<Chase>(scriptFrames);
+    char line[128];
+    snprintf(line, sizeof(line), "chase, C++:    %.2f us/frame on the host (%zu frames)", nativeUs, nativeFrames);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "chase, script: %.2f us/frame on the host (%zu frames, %zu bytes of bytecode)",
+             scriptUs, scriptFrames, sizeof(chaseScript));
+    TEST_MESSAGE(line);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fade);
+    RUN_TEST(test_nested_loops_and_waits);
+    RUN_TEST(test_shift_wraps_both_ways);
+    RUN_TEST(test_chase_script_matches_native);
+    return UNITY_END();
+}
@@ -0,0 +1,300 @@
+// Supply governor of src/supply.h: its levels, the runs of firmware.cpp it
+// refuses or stops, and a CR2032 drained press after press with the NeoSim
+// battery and power models (lib/NeoSim/Battery.h, Energy.h).
+//   pio test -e native -f test_supply -v
+// prints the discharge report.
+
+#include <Battery.h>
+#include <Energy.h>
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <stdio.h>
+
+// the sketch itself, with its setup(), loop() and supply governor
+#include "firmware.cpp"
+
+using supply::Governor;
+
+void setUp() {
+    neosim::reset();
+    rng = Rng();
+    supplyGovernor = Governor();
+    pixels.setBrightness(255);
+    pixels.clear();
+    pixels.begin();
+}
+
+void tearDown() {}
+
+void test_levels_only_go_down() {
+    Governor governor;
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_FRESH, governor.update(3000));
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_FRESH, governor.update(supply::LOW_MV));
+    // a low reading counts with the ones after it
+    for (uint8_t i = 1; i < supply::CONFIRM_READINGS; i++)
+        TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_FRESH, governor.update(supply::LOW_MV - 1));
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_LOW, governor.update(supply::LOW_MV - 1));
+    // a rested cell reads higher again
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_LOW, governor.update(3000));
+    // a reading at the level breaks the row
+    governor.update(supply::EMPTY_MV - 1);
+    governor.update(supply::LOW_MV - 1);
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_LOW, governor.update(supply::EMPTY_MV - 1));
+    // a row can skip a level, to the highest of its readings
+    governor.update(supply::EMPTY_MV - 1);
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_WEAK, governor.update(supply::WEAK_MV - 1));
+    for (uint8_t i = 0; i < supply::CONFIRM_READINGS; i++)
+        governor.update(supply::EMPTY_MV - 1);
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_EMPTY, governor.level);
+    TEST_ASSERT_FALSE(governor.allowsRun());
+    TEST_ASSERT_EQUAL_UINT8(0, governor.brightness());
+    // the first reading after a reset counts alone
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_EMPTY, Governor().update(supply::EMPTY_MV - 1));
+}
+
+void test_sag_under_load_steps_down() {
+    Governor governor;
+    TEST_ASSERT_TRUE(governor.holdsUnderLoad(supply::STOP_MV));
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_FRESH, governor.level);
+    TEST_ASSERT_FALSE(governor.holdsUnderLoad(supply::STOP_MV - 1));
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_LOW, governor.level);
+    // sags dim the strip and cheapen the runs, but only a reading at rest
+    // ends them
+    for (uint8_t sag = 0; sag < 10; sag++)
+        TEST_ASSERT_FALSE(governor.holdsUnderLoad(supply::STOP_MV - 1));
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_WEAK, governor.level);
+    TEST_ASSERT_TRUE(governor.allowsRun());
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_EMPTY, governor.update(supply::EMPTY_MV - 1));
+    // every level asks less of the cell than the one before
+    for (uint8_t level = supply::SUPPLY_LOW; level <= supply::SUPPLY_EMPTY; level++) {
+        Governor weaker{level}, stronger{(uint8_t) (level - 1)};
+        TEST_ASSERT_LESS_THAN_UINT8(stronger.brightness(), weaker.brightness());
+        TEST_ASSERT_LESS_THAN_UINT8(stronger.maxCost(), weaker.maxCost());
+    }
+}
+
+// picks stay within the budget of the level, and a fresh cell gets every
+// animation
+void test_picks_within_budget() {
+    for (uint8_t level = supply::SUPPLY_FRESH; level < supply::SUPPLY_EMPTY; level++) {
+        Governor governor{level};
+        schedule::Scheduler scheduler;
+        bool picked[player.count] = {};
+        for (uint16_t press = 0; press < 1000; press++) {
+            uint8_t index = scheduler.pick(registry, governor.maxCost(), rng);
+            TEST_ASSERT_LESS_THAN_UINT8(player.count, index);
+            TEST_ASSERT_LESS_OR_EQUAL_UINT(governor.maxCost(), registry[index].uAh);
+            picked[index] = true;
+        }
+        for (uint8_t index = 0; index < player.count; index++)
+            TEST_ASSERT_EQUAL(registry[index].uAh <= governor.maxCost(), picked[index]);
+    }
+}
+
+// an empty cell at the press: the boost converter stays off, the strip dark
+void test_empty_cell_gets_no_run() {
+    neosim::setSupplyMillivolts(supply::EMPTY_MV - 50);
+    setup();
+    for (uint8_t i = 0; i < 10; i++)
+        loop();
+    TEST_ASSERT_FALSE(player.running());
+    TEST_ASSERT_EQUAL_UINT8(LOW, neosim::pinState(BOOST_EN));
+    // the clear of setup() only
+    TEST_ASSERT_EQUAL(1, neosim::frames().size());
+}
+
+static uint16_t sagReadings;
+
+// fresh at rest, under the stop voltage once the strip is lit
+static uint16_t saggingCell() { return sagReadings++ ? supply::STOP_MV - 50 : 3000; }
+
+void test_sag_stops_the_run() {
+    sagReadings = 0;
+    neosim::setSupplySource(saggingCell);
+    setup();
+    uint16_t ticks = 0;
+    while (player.running() && ticks < 10000) {
+        loop();
+        ticks++;
+    }
+    TEST_ASSERT_FALSE(player.running());
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_LOW, supplyGovernor.level);
+    // the first reading under load, CHECK_FRAMES frames in, ended the run dark
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_LESS_OR_EQUAL(1 + supply::CHECK_FRAMES + 1, frames.size());
+    for (uint8_t byte: frames.back().bytes)
+        TEST_ASSERT_EQUAL_UINT8(0, byte);
+}
+
+// a cell that reads fresh at rest and below EMPTY_MV, but above STOP_MV,
+// with the strip lit
+static uint16_t loadedCell() { return neosim::pinState(BOOST_EN) == HIGH ? supply::EMPTY_MV - 100 : 3000; }
+
+// a press during a run restarts it with the boost converter on: that
+// reading is one under load, not one at rest that would empty the cell
+void test_restart_mid_run() {
+    static constexpr uint32_t PRESS_US = 500000;
+    neosim::setSupplySource(loadedCell);
+    neosim::schedulePin(BTN, LOW, PRESS_US);
+    neosim::schedulePin(BTN, HIGH, PRESS_US + 100000);
+    setup();
+    uint16_t ticks = 0;
+    while (neosim::now() < PRESS_US + 200000 && ticks < 10000) {
+        loop();
+        ticks++;
+    }
+    TEST_ASSERT_TRUE(player.running());
+    TEST_ASSERT_EQUAL_UINT8(supply::SUPPLY_FRESH, supplyGovernor.level);
+    TEST_ASSERT_EQUAL_UINT8(HIGH, neosim::pinState(BOOST_EN));
+}
+
+// charge and peak current of a run of each animation, at the brightness of
+// each supply level that allows a run
+struct Run {
+    float uAh;
+    float peakMa;
+};
+
+static constexpr void (*animations[])() = {
+        play<Heartbeat>, play<Bottomup>,  play<TheatherFill>, play<Bounce>,
+        play<IncrementalFill>, play<Chase>, play<ColorWipe>, play<Rainbow>,
+        play<TheaterChaseRainbow>, play<Bottomupsingle>, play<Firework>,
+};
+static_assert(sizeof(animations) / sizeof(animations[0]) == decltype(player)::count, "one per animation of the player");
+
+static Run runs[supply::SUPPLY_EMPTY][player.count];
+
+static void measureRuns() {
+    for (uint8_t level = supply::SUPPLY_FRESH; level < supply::SUPPLY_EMPTY; level++) {
+        Governor governor{level};
+        for (uint8_t index = 0; index < player.count; index++) {
+            setUp();
+            pixels.setBrightness(governor.brightness());
+            animations[index]();
+            // the frames up to the run limit of the level, the standby time
+            // in the same share
+            std::vector<neosim::Frame> frames = neosim::frames();
+            uint32_t endUs = neosim::now();
+            uint32_t sleptUs = neosim::sleptUs();
+            uint32_t limitUs = (uint32_t) governor.maxRunMs() * 1000;
+            if (limitUs && limitUs < endUs) {
+                while (!frames.empty() && frames.back().time >= limitUs)
+                    frames.pop_back();
+                sleptUs = (uint32_t) ((uint64_t) sleptUs * limitUs / endUs);
+                endUs = limitUs;
+            }
+            neosim::EnergyReport report = neosim::estimateEnergy(frames, endUs, NEO_GRB, sleptUs);
+            runs[level][index] = {report.mAh * 1000, report.peakMa};
+        }
+    }
+}
+
+// the TPS61240 drops out below its minimum input voltage: the strip
+// flickers out and the core browns out with it
+static constexpr float DROPOUT_V = 2.3f;
+
+struct Discharge {
+    uint32_t presses;     // runs played
+    uint32_t brownouts;   // of which the cell dropped out under
+    uint32_t firstBrownout;
+    float usedMah;
+};
+
+// Presses until the cell is empty, or until the governor refuses a run.
+// Each run draws its whole charge, even one stopped for sagging; the sleep
+// between presses is left out. The rest readings of the governor are off by
+// errorMv, and every glitchEvery-th one reads GLITCH_MV lower still.
+static constexpr uint16_t GLITCH_MV = 150;
+
+static Discharge discharge(bool governed, int16_t errorMv = 0, uint8_t glitchEvery = 0) {
+    neosim::Battery battery;
+    Governor governor;
+    schedule::Scheduler scheduler;
+    Discharge result = {};
+    rng = Rng();
+    while (!battery.empty()) {
+        if (governed) {
+            int16_t millivolts = (int16_t) (battery.openCircuitV() * 1000) + errorMv;
+            if (glitchEvery && result.presses % glitchEvery == glitchEvery - 1u)
+                millivolts -= GLITCH_MV;
+            governor.update((uint16_t) millivolts);
+            if (!governor.allowsRun())
+                break;
+        }
+        const Run &run = runs[governor.level][scheduler.pick(registry, governor.maxCost(), rng)];
+        float loadedV = battery.loadedV(run.peakMa);
+        if (loadedV < DROPOUT_V) {
+            if (!result.brownouts++)
+                result.firstBrownout = result.presses;
+        }
+        if (governed)
+            governor.holdsUnderLoad((uint16_t) (loadedV * 1000));
+        battery.draw(run.uAh / 1000);
+        result.presses++;
+    }
+    result.usedMah = battery.usedMah;
+    return result;
+}
+
+static void report(const char *name, const Discharge &result) {
+    char first[16] = "-";
+    if (result.brownouts)
+        snprintf(first, sizeof(first), "%u", result.firstBrownout);
+    char line[128];
+    snprintf(line, sizeof(line), "%-12s %8u  %9u  %14s  %8.1f", name, result.presses, result.brownouts, first,
+             result.usedMah);
+    TEST_MESSAGE(line);
+}
+
+// The same cell with and without the governor. Left alone it goes on past
+// its first drop-out, most runs after it drop out too; the governor ends the
+// runs before any does, and serves at least as many presses as went by
+// before the first drop-out: the sags near the end switch to dimmer and
+// cheaper runs, which fit more presses in the charge left. A dimmer level
+// lowers the peak current and so lets the cell run deeper, but the quiescent
+// current of the LEDs and the boost converter stays: a sag does not end the
+// runs, the rest reading at EMPTY_MV does.
+void test_discharge() {
+    measureRuns();
+    TEST_MESSAGE("level  animation   uAh/run   peak mA");
+    for (uint8_t level = supply::SUPPLY_FRESH; level < supply::SUPPLY_EMPTY; level++)
+        for (uint8_t index = 0; index < player.count; index++)
+            if (registry[index].uAh <= Governor{level}.maxCost()) {
+                char line[128];
+                snprintf(line, sizeof(line), "%5u  %9u  %8.1f  %8.2f", level, index, runs[level][index].uAh,
+                         runs[level][index].peakMa);
+                TEST_MESSAGE(line);
+            }
+
+    Discharge alone = discharge(false);
+    Discharge governed = discharge(true);
+    // the reference calibrated, what is left of the error either way, and
+    // the odd reading far off
+    Discharge readsHigh = discharge(true, supply::READING_ERROR_MV);
+    Discharge readsLow = discharge(true, -supply::READING_ERROR_MV);
+    Discharge glitches = discharge(true, 0, 5);
+    TEST_MESSAGE("cell          presses  brownouts  first brownout  used mAh");
+    report("alone", alone);
+    report("governed", governed);
+    report("reads high", readsHigh);
+    report("reads low", readsLow);
+    report("glitches", glitches);
+    TEST_ASSERT_GREATER_THAN(0, alone.brownouts);
+    for (const Discharge &result: {governed, readsHigh, readsLow, glitches}) {
+        TEST_ASSERT_EQUAL_UINT32(0, result.brownouts);
+        TEST_ASSERT_GREATER_OR_EQUAL(alone.firstBrownout, result.presses);
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_levels_only_go_down);
+    RUN_TEST(test_sag_under_load_steps_down);
+    RUN_TEST(test_picks_within_budget);
+    RUN_TEST(test_empty_cell_gets_no_run);
+    RUN_TEST(test_sag_stops_the_run);
+    RUN_TEST(test_restart_mid_run);
+    RUN_TEST(test_discharge);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+// Runs setup() and loop() of firmware.cpp on the host and measures the time
+// from a button press in power-down to the first frame on the strip.
+//   pio test -e native -f test_wake -v
+
+#include <NeoSim.h>
+#include <unity.h>
+
+#include <stdio.h>
+
+// the sketch itself, with its setup() and loop()
+#include "firmware.cpp"
+
+// The wake-up used to reset the chip: WDT_PERIOD_8CLK of the 1.024 kHz
+// watchdog clock, then the reset start-up time, SYSCFG1.SUT at its factory
+// default of 64 ms. The host only accounts for frames and sleep, so both
+// paths leave out the cycles the core spends computing.
+static constexpr uint32_t WDT_RESET_US = 8 * 1000000UL / 1024;
+static constexpr uint32_t STARTUP_US = 64000;
+
+// well after the first animation is over
+static constexpr uint32_t PRESS_US = 300000000UL;
+static constexpr uint32_t RELEASE_US = PRESS_US + 200000UL;
+
+void setUp() { neosim::reset(); }
+
+void tearDown() {}
+
+// runs loop() until a frame starts at or after us, returns its index
+static size_t runUntilFrameAfter(uint32_t us) {
+    const auto &frames = neosim::frames();
+    size_t seen = frames.size();
+    for (;;) {
+        loop();
+        for (; seen < frames.size(); seen++)
+            if (frames[seen].time >= us)
+                return seen;
+    }
+}
+
+static void report(const char *path, uint32_t firstShowUs, uint32_t firstAnimationUs) {
+    char line[128];
+    snprintf(line, sizeof(line), "%-12s press to first show() %6.2f ms, to first animation frame %6.2f ms", path,
+             firstShowUs / 1000.0, firstAnimationUs / 1000.0);
+    TEST_MESSAGE(line);
+}
+
+// the reboot the wake-up went through before: the press is at time 0
+void test_cold_boot_latency() {
+    neosim::advance(WDT_RESET_US + STARTUP_US);
+    setup();
+    // setup() clears the strip, the animation comes after it
+    runUntilFrameAfter(0);
+    const auto &frames = neosim::frames();
+    TEST_ASSERT_GREATER_OR_EQUAL(2, frames.size());
+    report("cold boot", frames[0].time, frames[1].time);
+    TEST_ASSERT_GREATER_OR_EQUAL(WDT_RESET_US + STARTUP_US, frames[0].time);
+}
+
+// the warm resume: the core goes on from power-down with SRAM as it was
+void test_warm_resume_latency() {
+    neosim::schedulePin(BTN, LOW, PRESS_US);
+    neosim::schedulePin(BTN, HIGH, RELEASE_US);
+    setup();
+    size_t first = runUntilFrameAfter(PRESS_US);
+    // the first animation had ended and the core was in power-down
+    TEST_ASSERT_EQUAL_UINT32(1, neosim::wakeUps());
+    TEST_ASSERT_EQUAL_UINT8(HIGH, neosim::pinState(BOOST_EN));
+    uint32_t latency = neosim::frames()[first].time - PRESS_US;
+    report("warm resume", latency, latency);
+    TEST_ASSERT_LESS_THAN(WDT_RESET_US, latency);
+}
+
+// the release of a press held past the end of an animation wakes the core
+// up too, it goes back to power-down until the next press
+void test_release_goes_back_to_sleep() {
+    neosim::schedulePin(BTN, LOW, 100000);
+    neosim::schedulePin(BTN, HIGH, PRESS_US);
+    neosim::schedulePin(BTN, LOW, PRESS_US + 1000000);
+    setup();
+    size_t first = runUntilFrameAfter(PRESS_US);
+    TEST_ASSERT_EQUAL_UINT32(2, neosim::wakeUps());
+    TEST_ASSERT_GREATER_OR_EQUAL(PRESS_US + 1000000, neosim::frames()[first].time);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cold_boot_latency);
+    RUN_TEST(test_warm_resume_latency);
+    RUN_TEST(test_release_goes_back_to_sleep);
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Compile NeoHeart animation scripts into PROGMEM arrays.
+
+    tools/nhscript.py scripts/chase.nhs [...]
+
+writes src/scripts/chase.h with `chaseScript[]`, ready to be played by the
+Script<> animation of firmware.h. The bytecode is described in src/script.h.
+
+Listed in platformio.ini as a pre: extra script, it recompiles every
+scripts/*.nhs that is newer than its header before each build.
+
+Script syntax, one instruction per line, `#` starts a comment:
+
+    color R G B          color random
+    set PIXEL LEVEL      fill LEVEL          clear
+    shift N              show                wait MS
+    fade FROM TO STEPS MS
+    loop COUNT ... end
+
+Levels are 0-255 or a percentage of full (`60%`, rounded down like the
+fraction() helper).
+"""
+
+import os
+import sys
+
+# keep in step with enum ScriptOp in src/script.h
+OPCODES = {
+    "end": 0x00,
+    "color": 0x01,
+    "random": 0x02,
+    "set": 0x03,
+    "fill": 0x04,
+    "clear": 0x05,
+    "shift": 0x06,
+    "show": 0x07,
+    "wait": 0x08,
+    "fade": 0x09,
+    "loop": 0x0A,
+    "next": 0x0B,
+}
+LOOP_DEPTH = 3  # SCRIPT_LOOP_DEPTH
+LEVEL_FULL = 255
+
+
+class ScriptError(Exception):
+    pass
+
+
+def number(text, low, high, what):
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise ScriptError("%s must be a number, not '%s'" % (what, text))
+    if not low <= value <= high:
+        raise ScriptError("%s must be %d-%d, not %d" % (what, low, high, value))
+    return value
+
+
+def level(text):
+    if text.endswith("%"):
+        percent = number(text[:-1], 0, 100, "level")
+        return percent * LEVEL_FULL // 100
+    return number(text, 0, LEVEL_FULL, "level")
+
+
+def compile_script(source, pixel_count=25):
+    """Return the bytecode for the script text, raise ScriptError on errors"""
+    code = bytearray()
+    loops = []
+    for line_number, line in enumerate(source.splitlines(), 1):
+        words = line.split("#", 1)[0].split()
+        if not words:
+            continue
+        op, args = words[0].lower(), words[1:]
+
+        def expect(count):
+            if len(args) != count:
+                raise ScriptError("'%s' takes %d operand%s" % (op, count, "" if count == 1 else "s"))
+
+        try:
+            if op == "color" and args == ["random"]:
+                code += bytes([OPCODES["random"]])
+            elif op == "color":
+                expect(3)
+                code += bytes([OPCODES[op]] + [number(a, 0, 255, "channel") for a in args])
+            elif op == "set":
+                expect(2)
+                code += bytes([OPCODES[op], number(args[0], 0, pixel_count - 1, "pixel"), level(args[1])])
+            elif op == "fill":
+                expect(1)
+                code += bytes([OPCODES[op], level(args[0])])
+            elif op in ("clear", "show"):
+                expect(0)
+                code += bytes([OPCODES[op]])
+            elif op == "shift":
+                expect(1)
+                code += bytes([OPCODES[op], number(args[0], -127, 127, "shift") & 0xFF])
+            elif op == "wait":
+                expect(1)
+                ms = number(args[0], 0, 65535, "wait")
+                code += bytes([OPCODES[op], ms & 0xFF, ms >> 8])
+            elif op == "fade":
+                expect(4)
+                code += bytes([OPCODES[op], level(args[0]), level(args[1]),
+                               number(args[2], 1, 255, "steps"), number(args[3], 0, 255, "fade wait")])
+            elif op == "loop":
+                expect(1)
+                if len(loops) == LOOP_DEPTH:
+                    raise ScriptError("loops nest at most %d deep" % LOOP_DEPTH)
+                loops.append(line_number)
+                code += bytes([OPCODES[op], number(args[0], 1, 255, "loop count")])
+            elif op == "end":
+                expect(0)
+                if not loops:
+                    raise ScriptError("'end' without 'loop'")
+                loops.pop()
+                code += bytes([OPCODES["next"]])
+            else:
+                raise ScriptError("unknown instruction '%s'" % op)
+        except ScriptError as error:
+            raise ScriptError("line %d: %s" % (line_number, error))
+    if loops:
+        raise ScriptError("line %d: 'loop' without 'end'" % loops[-1])
+    code += bytes([OPCODES["end"]])
+    return bytes(code)
+
+
+def header(name, source_path, code):
+    rows = []
+    for start in range(0, len(code), 12):
+        rows.append("        " + ", ".join("0x%02x" % b for b in code[start:start + 12]) + ",")
+    return (
+        "// Generated by tools/nhscript.py from %s, do not edit.\n"
+        "#ifndef NEOHEART_SCRIPT_%s_H\n"
+        "#define NEOHEART_SCRIPT_%s_H\n"
+        "\n"
+        "#include <Arduino.h>\n"
+        "\n"
+        "namespace neoheart {\n"
+        "static const uint8_t %sScript[%d] PROGMEM = {\n"
+        "%s\n"
+        "};\n"
+        "}  // namespace neoheart\n"
+        "\n"
+        "#endif\n" % (source_path, name.upper(), name.upper(), name, len(code), "\n".join(rows)))
+
+
+def compile_file(path, out_dir):
+    name = os.path.splitext(os.path.basename(path))[0]
+    with open(path) as source:
+        try:
+            code = compile_script(source.read())
+        except ScriptError as error:
+            raise ScriptError("%s: %s" % (os.path.basename(path), error))
+    out_path = os.path.join(out_dir, name + ".h")
+    relative = os.path.relpath(path, os.path.join(out_dir, "..", ".."))
+    with open(out_path, "w") as out:
+        out.write(header(name, relative.replace(os.sep, "/"), code))
+    return out_path, len(code)
+
+
+def compile_project(project_dir):
+    scripts = os.path.join(project_dir, "scripts")
+    out_dir = os.path.join(project_dir, "src", "scripts")
+    for entry in sorted(os.listdir(scripts)):
+        if not entry.endswith(".nhs"):
+            continue
+        path = os.path.join(scripts, entry)
+        out_path = os.path.join(out_dir, entry[:-4] + ".h")
+        if not os.path.exists(out_path) or os.path.getmtime(out_path) < os.path.getmtime(path):
+            out_path, size = compile_file(path, out_dir)
+            print("nhscript: %s -> %s (%d bytes)" % (entry, os.path.relpath(out_path, project_dir), size))
+
+
+def main(argv):
+    project_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    out_dir = os.path.join(project_dir, "src", "scripts")
+    if not argv:
+        print(__doc__.strip())
+        return 2
+    for path in argv:
+        try:
+            out_path, size = compile_file(path, out_dir)
+        except ScriptError as error:
+            print(error, file=sys.stderr)
+            return 1
+        print("%s -> %s (%d bytes)" % (path, os.path.relpath(out_path), size))
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 - defined when run by PlatformIO as an extra script
+except NameError:
+    env = None
+
+if env is not None:
+    try:
+        compile_project(env.subst("$PROJECT_DIR"))
+    except ScriptError as error:
+        print("nhscript: %s" % error, file=sys.stderr)
+        env.Exit(1)
+elif __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))